@@ -222,6 +222,70 @@ class CSVDataGenerator(object):
 
         return True
 
+# Must match dbc_hash() in engine/dbc/dbc.hpp
+def dbc_hash(id, seed):
+    x = (id ^ seed) & 0xFFFFFFFF
+    x ^= x >> 16
+    x = (x * 0x7feb352d) & 0xFFFFFFFF
+    x ^= x >> 15
+    x = (x * 0x846ca68b) & 0xFFFFFFFF
+    x ^= x >> 16
+    return x
+
+# Output a perfect hash from ids to their positions in the data array (hash and displace). Ids
+# are spread to buckets with seed 0, and each bucket gets the first seed that maps all of its ids
+# to free slots. Empty slots hold len(ids), the position of the terminating zero entry.
+def output_id_hash(generator, data_str, ids):
+    n_slots = 1
+    while n_slots < len(ids) * 5 // 4:
+        n_slots <<= 1
+
+    n_buckets = 1
+    while n_buckets < len(ids) // 2:
+        n_buckets <<= 1
+
+    buckets = [ [] for _ in range(n_buckets) ]
+    for index, id in enumerate(ids):
+        buckets[dbc_hash(id, 0) & (n_buckets - 1)].append((id, index))
+
+    seeds = [ 0 ] * n_buckets
+    slots = [ len(ids) ] * n_slots
+    # Place large buckets first, while most slots are still free
+    for bucket_id in sorted(range(n_buckets), key = lambda b: -len(buckets[b])):
+        bucket = buckets[bucket_id]
+        if len(bucket) == 0:
+            break
+
+        seed = 1
+        while True:
+            positions = [ dbc_hash(id, seed) & (n_slots - 1) for id, _ in bucket ]
+            if len(set(positions)) == len(positions) and all(slots[p] == len(ids) for p in positions):
+                break
+            seed += 1
+
+        seeds[bucket_id] = seed
+        for position, (_, index) in zip(positions, bucket):
+            slots[position] = index
+
+    prefix = generator._options.prefix and ('%s_' % generator._options.prefix) or ''
+    suffix = generator._options.suffix and ('_%s' % generator._options.suffix) or ''
+
+    generator._out.write('#define %s%s_HASH%s_SIZE (%d)\n' % (
+        prefix.upper(), data_str.upper(), suffix.upper(), len(ids)))
+    generator._out.write('#define %s%s_HASH%s_BUCKETS (%d)\n' % (
+        prefix.upper(), data_str.upper(), suffix.upper(), n_buckets))
+    generator._out.write('#define %s%s_HASH%s_SLOTS (%d)\n\n' % (
+        prefix.upper(), data_str.upper(), suffix.upper(), n_slots))
+
+    for table_str, table in [ ('seeds', seeds), ('slots', slots) ]:
+        generator._out.write('// %d %s hash %s, wow build level %d\n' % (
+            len(table), data_str, table_str, generator._options.build ))
+        generator._out.write('static const unsigned __%s%s_hash%s_%s[] = {\n' % (
+            prefix, data_str, suffix, table_str))
+        for i in range(0, len(table), 16):
+            generator._out.write('  %s,\n' % ', '.join('%u' % v for v in table[i:i + 16]))
+        generator._out.write('};\n\n')
+
 class DataGenerator(object):
     _class_names = [ None, 'Warrior', 'Paladin', 'Hunter', 'Rogue',     'Priest', 'Death Knight', 'Shaman', 'Mage',  'Warlock', 'Monk',       'Druid', 'Demon Hunter'  ]
     _class_masks = [ None, 0x1,       0x2,       0x4,      0x8,         0x10,     0x20, 0x40,     0x80,    0x100,     0x200,        0x400, 0x800   ]
@@ -2482,6 +2546,7 @@ class SpellDataGenerator(DataGenerator):
         ))
 
         index = 0
+        spell_ids = []
         for id in id_keys + [0]:
             spell = self._spellname_db[id]
             hotfix_flags = 0
@@ -2736,10 +2801,15 @@ class SpellDataGenerator(DataGenerator):
                 sys.stderr.write('Error: %s\n%s\n' % (e, fields))
                 sys.exit(1)
 
+            if spell.id > 0:
+                spell_ids.append(spell.id)
+
             index += 1
 
         self._out.write('};\n\n')
 
+        output_id_hash(self, 'spell', spell_ids)
+
         self._out.write('#define __%sSPELLEFFECT%s_SIZE (%d)\n\n' % (
             (self._options.prefix and ('%s_' % self._options.prefix) or '').upper(),
             (self._options.suffix and ('_%s' % self._options.suffix) or '').upper(),
@@ -2750,6 +2820,7 @@ class SpellDataGenerator(DataGenerator):
             self._options.suffix and ('_%s' % self._options.suffix) or ''))
 
         index = 0
+        spelleffect_ids = []
         for effect_data in sorted(effects) + [ ( 0, 0 ) ]:
             effect = self._spelleffect_db[effect_data[0]]
             if not effect.id and effect_data[ 0 ] > 0:
@@ -2859,10 +2930,15 @@ class SpellDataGenerator(DataGenerator):
                 sys.stderr.write('%s\n' % fields)
                 sys.exit(1)
 
+            if effect.id > 0:
+                spelleffect_ids.append(effect.id)
+
             index += 1
 
         self._out.write('};\n\n')
 
+        output_id_hash(self, 'spelleffect', spelleffect_ids)
+
         index = 0
         def sortf( a, b ):
             if a.id > b.id:
@@ -2879,6 +2955,7 @@ class SpellDataGenerator(DataGenerator):
         self._out.write('// %d effects, wow build level %d\n' % ( len(powers), self._options.build ))
         self._out.write('static struct spellpower_data_t __%s_data[] = {\n' % ( self.format_str( "spellpower" ) ))
 
+        power_ids = []
         for power in powers + [ self._spellpower_db[0] ]:
             hotfix_flags = 0
             hotfix_data = []
@@ -2914,8 +2991,13 @@ class SpellDataGenerator(DataGenerator):
                 sys.stderr.write('%s\n' % fields)
                 sys.exit(1)
 
+            if power.id > 0:
+                power_ids.append(power.id)
+
         self._out.write('};\n\n')
 
+        output_id_hash(self, 'spellpower', power_ids)
+
         labels = []
         for label_id, label_data in self._spelllabel_db.items():
             if label_data.label not in included_labels:
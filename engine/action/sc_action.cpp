@@ -91,7 +91,11 @@ struct player_gcd_event_t : public player_event_t
  */
 void do_off_gcd_execute( action_t* action )
 {
-  action->execute();
+  {
+    event_profile_t::scope_t profile( action->sim->event_mgr.profile.get(), event_profile_t::PROFILE_ACTION_EXECUTE,
+                                      action->player, action->name() );
+    action->execute();
+  }
   action->line_cooldown.start();
   if ( !action->quiet )
   {
@@ -244,6 +248,8 @@ struct action_execute_event_t : public player_event_t
       // Action target must follow any potential pre-execute-state target if it differs from the
       // current (default) target of the action.
       action->set_target( target );
+      event_profile_t::scope_t profile( sim().event_mgr.profile.get(), event_profile_t::PROFILE_ACTION_EXECUTE,
+                                        action->player, action->name() );
       action->execute();
     }
 
@@ -493,6 +499,7 @@ action_t::action_t( action_e ty, const std::string& token, player_t* p, const sp
     option(),
     interrupt_global( false ),
     if_expr(),
+    if_program(),
     target_if_mode( TARGET_IF_NONE ),
     target_if_expr(),
     interrupt_if_expr(),
@@ -503,6 +510,8 @@ action_t::action_t( action_e ty, const std::string& token, player_t* p, const sp
     action_list(),
     starved_proc(),
     total_executions(),
+    if_cache_hits(),
+    if_cache_misses(),
     line_cooldown( "line_cd", *p ),
     signature(),
     execute_state(),
@@ -512,6 +521,7 @@ action_t::action_t( action_e ty, const std::string& token, player_t* p, const sp
     target_cache(),
     options(),
     state_cache(),
+    allocated_states( 0 ),
     travel_events()
 {
   assert( option.cycle_targets == 0 );
@@ -2150,7 +2160,27 @@ bool action_t::action_ready()
   if ( option.moving != -1 && option.moving != ( player->is_moving() ? 1 : 0 ) )
     return false;
 
-  if ( if_expr && !if_expr->success() )
+  if ( if_program )
+  {
+    double value;
+    if ( !sim->cache_expressions )
+      value = if_program->run();
+    else if ( if_program->cacheable() )
+    {
+      bool hit;
+      value = if_program->run_cached( hit );
+      ++( hit ? if_cache_hits : if_cache_misses );
+    }
+    else
+    {
+      value = if_program->run();
+      ++if_cache_misses;
+    }
+
+    if ( value == 0 )
+      return false;
+  }
+  else if ( if_expr && !if_expr->success() )
     return false;
 
   return true;
@@ -2444,6 +2474,9 @@ void action_t::reset()
   travel_events.clear();
   target = default_target;
 
+  if ( if_program )
+    if_program->invalidate();
+
   if( player->nth_iteration() == 1 )
   {
     if ( if_expr )
@@ -2458,6 +2491,8 @@ void action_t::reset()
           action_list->foreground_action_list.erase( i );
         }
       }
+      if ( sim->compile_expressions || sim->cache_expressions )
+        if_program = expression::compile( if_expr, &sim->event_mgr.current_time );
     }
     if ( target_if_expr )
       target_if_expr = target_if_expr->optimize();
@@ -17,6 +17,7 @@ action_state_t* action_t::get_state( const action_state_t* other )
   else
   {
     s = new_state();
+    allocated_states++;
   }
 
   s->action = this;
@@ -1110,7 +1110,11 @@ void dot_t::tick()
         current_tick, num_ticks, last_start.total_seconds(),
         current_duration.total_seconds(), time_to_tick.total_seconds() );
 
-  current_action->tick( this );
+  {
+    event_profile_t::scope_t profile( sim.event_mgr.profile.get(), event_profile_t::PROFILE_ACTION_TICK,
+                                      current_action->player, current_action->name() );
+    current_action->tick( this );
+  }
   prev_tick_time = sim.current_time();
 }
 
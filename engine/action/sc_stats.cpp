@@ -43,6 +43,11 @@ stats_t::stats_t( const std::string& n, player_t* p ) :
   scaling( nullptr ),
   timeline_amount( nullptr )
 {
+  actual_amount.enable_sketch( sim.statistics_sketch );
+  total_amount.enable_sketch( sim.statistics_sketch );
+  portion_aps.enable_sketch( sim.statistics_sketch );
+  portion_apse.enable_sketch( sim.statistics_sketch );
+
   int size = std::min( sim.iterations, 10000 );
   actual_amount.reserve( size );
   total_amount.reserve( size );
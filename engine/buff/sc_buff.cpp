@@ -246,6 +246,14 @@ expr_t* create_buff_expression( std::string buff_name, const std::string& type,
 
       double evaluate() override
       { return buff()->buff_duration.total_seconds(); }
+
+      void compile( expression::program_t& prog ) override
+      {
+        if ( static_buff )
+          prog.emit_load( this, static_buff->buff_duration );
+        else
+          buff_expr_t::compile( prog );
+      }
     };
 
     return new duration_expr_t( buff_name, action, static_buff );
@@ -287,6 +295,14 @@ expr_t* create_buff_expression( std::string buff_name, const std::string& type,
 
       double evaluate() override
       { return buff()->check() > 0; }
+
+      void compile( expression::program_t& prog ) override
+      {
+        if ( static_buff )
+          prog.emit_load_positive( static_buff->current_stack, true );
+        else
+          buff_expr_t::compile( prog );
+      }
     };
 
     return new up_expr_t( buff_name, action, static_buff );
@@ -301,6 +317,14 @@ expr_t* create_buff_expression( std::string buff_name, const std::string& type,
 
       double evaluate() override
       { return buff()->check() <= 0; }
+
+      void compile( expression::program_t& prog ) override
+      {
+        if ( static_buff )
+          prog.emit_load_positive( static_buff->current_stack, false );
+        else
+          buff_expr_t::compile( prog );
+      }
     };
 
     return new down_expr_t( buff_name, action, static_buff );
@@ -314,6 +338,14 @@ expr_t* create_buff_expression( std::string buff_name, const std::string& type,
 
       double evaluate() override
       { return buff()->check(); }
+
+      void compile( expression::program_t& prog ) override
+      {
+        if ( static_buff )
+          prog.emit_load( this, static_buff->current_stack );
+        else
+          buff_expr_t::compile( prog );
+      }
     };
 
     return new stack_expr_t( buff_name, action, static_buff );
@@ -1195,6 +1227,10 @@ bool buff_t::trigger( int stacks, double value, double chance, timespan_t durati
   if ( player && player->is_sleeping() )
     return false;
 
+  // Only triggers that get to roll are profiled
+  event_profile_t::scope_t profile( sim->event_mgr.profile.get(), event_profile_t::PROFILE_BUFF_TRIGGER, player,
+                                    name() );
+
   trigger_attempts++;
 
   if ( rppm )
@@ -1751,6 +1787,9 @@ void buff_t::expire( timespan_t delay )
     event_t::cancel( expiration_delay );
   }
 
+  event_profile_t::scope_t profile( sim->event_mgr.profile.get(), event_profile_t::PROFILE_BUFF_EXPIRE, player,
+                                    name() );
+
   timespan_t remaining_duration = timespan_t::zero();
   int expiration_stacks         = current_stack;
   if ( !expiration.empty() )
@@ -1958,6 +1997,17 @@ void buff_t::analyze()
   }
 }
 
+// buff_t::memory_size ======================================================
+
+size_t buff_t::memory_size() const
+{
+  return sizeof( buff_t ) + expiration.capacity() * sizeof( event_t* ) +
+         stack_react_time.capacity() * sizeof( timespan_t ) +
+         stack_react_ready_triggers.capacity() * sizeof( event_t* ) +
+         invalidate_list.capacity() * sizeof( cache_e ) +
+         stack_uptime.capacity() * sizeof( uptime_common_t );
+}
+
 // buff_t::find =============================================================
 
 buff_t* buff_t::find( const std::vector<buff_t*>& buffs, const std::string& name_str, player_t* source )
@@ -2033,6 +2083,14 @@ buff_t* buff_t::find_expressable( const std::vector<buff_t*>& buffs, const std::
     return find( buffs, name, source );
 }
 
+buff_t* buff_t::find_expressable( player_t* p, const std::string& name, player_t* source )
+{
+  if ( util::str_compare_ci( "potion", name ) )
+    return find_potion_buff( p->buff_list, source );
+  else
+    return find( p, name, source );
+}
+
 // buff_t::to_str ===========================================================
 
 std::string buff_t::to_str() const
@@ -2086,12 +2144,13 @@ void buff_t::invalidate_cache()
 
 buff_t* buff_t::find( sim_t* s, const std::string& name )
 {
-  return find( s->buff_list, name );
+  return s->buff_index.find( s->buff_list, name );
 }
 
 buff_t* buff_t::find( player_t* p, const std::string& name, player_t* source )
 {
-  return find( p->buff_list, name, source );
+  return p->buff_index.find( p->buff_list, name,
+                             [ source ]( const buff_t* b ) { return !source || source == b->source; } );
 }
 
 std::string buff_t::source_name() const
@@ -356,6 +356,8 @@ public:
   virtual void aura_loss();
   virtual void merge( const buff_t& other_buff );
   virtual void analyze();
+  // Heap memory held by the buff, excluding its uptime timeline
+  size_t memory_size() const;
   virtual void datacollection_begin();
   virtual void datacollection_end();
   virtual void init();
@@ -384,6 +386,7 @@ public:
   static buff_t* find(    sim_t*, const std::string& name );
   static buff_t* find( player_t*, const std::string& name, player_t* source = nullptr );
   static buff_t* find_expressable( const std::vector<buff_t*>&, const std::string& name, player_t* source = nullptr );
+  static buff_t* find_expressable( player_t*, const std::string& name, player_t* source = nullptr );
 
   const char* name() const { return name_str.c_str(); }
   std::string source_name() const;
@@ -1788,34 +1788,30 @@ double paladin_t::temporary_movement_modifier() const
   return temporary;
 }
 
-// paladin_t::invalidate_cache ==============================================
+// paladin_t::init_cache_dependencies =======================================
 
-void paladin_t::invalidate_cache( cache_e c )
+void paladin_t::init_cache_dependencies()
 {
-  player_t::invalidate_cache( c );
+  player_t::init_cache_dependencies();
 
-  if ( ( specialization() == PALADIN_RETRIBUTION || specialization() == PALADIN_PROTECTION )
-       && ( c == CACHE_STRENGTH || c == CACHE_ATTACK_POWER )
-     )
+  if ( specialization() == PALADIN_RETRIBUTION || specialization() == PALADIN_PROTECTION )
   {
-    player_t::invalidate_cache( CACHE_SPELL_POWER );
+    cache.add_dependency( CACHE_STRENGTH, CACHE_SPELL_POWER );
+    cache.add_dependency( CACHE_ATTACK_POWER, CACHE_SPELL_POWER );
   }
 
-  if ( c == CACHE_ATTACK_CRIT_CHANCE && specialization() == PALADIN_PROTECTION )
-    player_t::invalidate_cache( CACHE_PARRY );
-
+  if ( specialization() == PALADIN_PROTECTION )
+    cache.add_dependency( CACHE_ATTACK_CRIT_CHANCE, CACHE_PARRY );
 
-  if ( c == CACHE_MASTERY && passives.divine_bulwark -> ok() )
+  if ( passives.divine_bulwark -> ok() )
   {
-    player_t::invalidate_cache( CACHE_BLOCK );
-    player_t::invalidate_cache( CACHE_ATTACK_POWER );
-    player_t::invalidate_cache( CACHE_SPELL_POWER );
+    cache.add_dependency( CACHE_MASTERY, CACHE_BLOCK );
+    cache.add_dependency( CACHE_MASTERY, CACHE_ATTACK_POWER );
+    cache.add_dependency( CACHE_MASTERY, CACHE_SPELL_POWER );
   }
 
-  if ( c == CACHE_ATTACK_POWER && spells.shield_of_the_righteous -> ok() )
-  {
-    player_t::invalidate_cache( CACHE_BONUS_ARMOR );
-  }
+  if ( spells.shield_of_the_righteous -> ok() )
+    cache.add_dependency( CACHE_ATTACK_POWER, CACHE_BONUS_ARMOR );
 }
 
 // paladin_t::matching_gear_multiplier ======================================
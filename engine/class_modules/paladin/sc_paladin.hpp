@@ -445,7 +445,7 @@ public:
   virtual void      assess_heal( school_e, dmg_e, action_state_t* ) override;
   virtual void      target_mitigation( school_e, dmg_e, action_state_t* ) override;
 
-  virtual void      invalidate_cache( cache_e ) override;
+  virtual void      init_cache_dependencies() override;
   virtual void      create_options() override;
   virtual double    matching_gear_multiplier( attribute_e attr ) const override;
   virtual action_t* create_action( const std::string& name, const std::string& options_str ) override;
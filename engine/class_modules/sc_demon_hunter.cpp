@@ -520,6 +520,7 @@ public:
   void init_scaling() override;
   void init_spells() override;
   void invalidate_cache( cache_e ) override;
+  void init_cache_dependencies() override;
   resource_e primary_resource() const override;
   role_e primary_role() const override;
 
@@ -4834,14 +4835,9 @@ void demon_hunter_t::invalidate_cache( cache_e c )
   switch ( c )
   {
     case CACHE_MASTERY:
+      // Run speed changes need to adjust movement as well
       if ( mastery.demonic_presence->ok() )
         invalidate_cache( CACHE_RUN_SPEED );
-      if ( mastery.fel_blood->ok() )
-        invalidate_cache( CACHE_ARMOR );
-      break;
-    case CACHE_CRIT_CHANCE:
-      if ( spec.riposte->ok() )
-        invalidate_cache( CACHE_PARRY );
       break;
     case CACHE_RUN_SPEED:
       adjust_movement();
@@ -4855,6 +4851,23 @@ void demon_hunter_t::invalidate_cache( cache_e c )
   }
 }
 
+// demon_hunter_t::init_cache_dependencies ==================================
+
+void demon_hunter_t::init_cache_dependencies()
+{
+  player_t::init_cache_dependencies();
+
+  if ( mastery.demonic_presence->ok() )
+    cache.add_side_effect( CACHE_MASTERY );
+  cache.add_side_effect( CACHE_RUN_SPEED );
+  cache.add_side_effect( CACHE_AGILITY );
+
+  if ( mastery.fel_blood->ok() )
+    cache.add_dependency( CACHE_MASTERY, CACHE_ARMOR );
+  if ( spec.riposte->ok() )
+    cache.add_dependency( CACHE_CRIT_CHANCE, CACHE_PARRY );
+}
+
 // demon_hunter_t::primary_resource =========================================
 
 resource_e demon_hunter_t::primary_resource() const
@@ -786,6 +786,7 @@ public:
   std::string       default_food() const override;
   std::string       default_rune() const override;
   virtual void      invalidate_cache( cache_e ) override;
+  virtual void      init_cache_dependencies() override;
   virtual void      arise() override;
   virtual void      reset() override;
   virtual void      merge( player_t& other ) override;
@@ -8459,24 +8460,9 @@ void druid_t::invalidate_cache( cache_e c )
 
   switch ( c )
   {
-  case CACHE_ATTACK_POWER:
-    if ( specialization() == DRUID_GUARDIAN || specialization() == DRUID_FERAL )
-      invalidate_cache( CACHE_SPELL_POWER );
-    break;
-  case CACHE_SPELL_POWER:
-    if ( specialization() == DRUID_BALANCE || specialization() == DRUID_RESTORATION )
-      invalidate_cache( CACHE_ATTACK_POWER );
-    break;
   case CACHE_MASTERY:
     if ( mastery.natures_guardian -> ok() )
-    {
-      invalidate_cache( CACHE_ATTACK_POWER );
       recalculate_resource_max( RESOURCE_HEALTH );
-    }
-    break;
-  case CACHE_CRIT_CHANCE:
-    if ( specialization() == DRUID_GUARDIAN )
-      invalidate_cache( CACHE_DODGE );
     break;
   case CACHE_AGILITY:
     if ( buff.ironfur -> check() )
@@ -8487,6 +8473,26 @@ void druid_t::invalidate_cache( cache_e c )
   }
 }
 
+// druid_t::init_cache_dependencies =========================================
+
+void druid_t::init_cache_dependencies()
+{
+  player_t::init_cache_dependencies();
+
+  if ( mastery.natures_guardian -> ok() )
+    cache.add_side_effect( CACHE_MASTERY );
+  cache.add_side_effect( CACHE_AGILITY );
+
+  if ( specialization() == DRUID_GUARDIAN || specialization() == DRUID_FERAL )
+    cache.add_dependency( CACHE_ATTACK_POWER, CACHE_SPELL_POWER );
+  if ( specialization() == DRUID_BALANCE || specialization() == DRUID_RESTORATION )
+    cache.add_dependency( CACHE_SPELL_POWER, CACHE_ATTACK_POWER );
+  if ( mastery.natures_guardian -> ok() )
+    cache.add_dependency( CACHE_MASTERY, CACHE_ATTACK_POWER );
+  if ( specialization() == DRUID_GUARDIAN )
+    cache.add_dependency( CACHE_CRIT_CHANCE, CACHE_DODGE );
+}
+
 // druid_t::composite_melee_attack_power ===============================
 
 double druid_t::composite_melee_attack_power() const
@@ -592,6 +592,7 @@ public:
   double    composite_player_pet_damage_multiplier( const action_state_t* ) const override;
   double    matching_gear_multiplier( attribute_e attr ) const override;
   void      invalidate_cache( cache_e ) override;
+  void      init_cache_dependencies() override;
   void      regen( timespan_t periodicity ) override;
   void      create_options() override;
   expr_t*   create_expression( const std::string& name ) override;
@@ -5737,6 +5738,16 @@ void hunter_t::invalidate_cache( cache_e c )
   }
 }
 
+// hunter_t::init_cache_dependencies =========================================
+
+void hunter_t::init_cache_dependencies()
+{
+  player_t::init_cache_dependencies();
+
+  if ( mastery.sniper_training -> ok() && sim -> distance_targeting_enabled )
+    cache.add_side_effect( CACHE_MASTERY );
+}
+
 // hunter_t::regen =========================================================
 
 void hunter_t::regen( timespan_t periodicity )
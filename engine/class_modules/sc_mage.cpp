@@ -668,6 +668,7 @@ public:
   virtual void        init_uptimes() override;
   virtual void        init_rng() override;
   virtual void        invalidate_cache( cache_e c ) override;
+  virtual void        init_cache_dependencies() override;
   virtual void        init_resources( bool force ) override;
   virtual void        recalculate_resource_max( resource_e rt ) override;
   virtual void        reset() override;
@@ -6760,21 +6761,28 @@ void mage_t::invalidate_cache( cache_e c )
         recalculate_resource_max( RESOURCE_MANA );
       }
       break;
-    case CACHE_SPELL_CRIT_CHANCE:
-      // Combustion makes mastery dependent on spell crit chance rating. Thus
-      // any spell_crit_chance invalidation (which should include any
-      // spell_crit_rating changes) will also invalidate mastery.
-      if ( specialization() == MAGE_FIRE )
-      {
-        invalidate_cache( CACHE_MASTERY );
-      }
-      break;
     default:
       break;
   }
 
 }
 
+// mage_t::init_cache_dependencies ============================================
+
+void mage_t::init_cache_dependencies()
+{
+  player_t::init_cache_dependencies();
+
+  if ( spec.savant -> ok() )
+    cache.add_side_effect( CACHE_MASTERY );
+
+  // Combustion makes mastery dependent on spell crit chance rating. Thus
+  // any spell_crit_chance invalidation (which should include any
+  // spell_crit_rating changes) will also invalidate mastery.
+  if ( specialization() == MAGE_FIRE )
+    cache.add_dependency( CACHE_SPELL_CRIT_CHANCE, CACHE_MASTERY );
+}
+
 // mage_t::recalculate_resource_max ===========================================
 
 void mage_t::recalculate_resource_max( resource_e rt )
@@ -813,7 +813,7 @@ public:
   virtual void assess_damage( school_e, dmg_e, action_state_t* s ) override;
   virtual void assess_damage_imminent_pre_absorb( school_e, dmg_e, action_state_t* s ) override;
   virtual void assess_heal( school_e, dmg_e, action_state_t* s ) override;
-  virtual void invalidate_cache( cache_e ) override;
+  virtual void init_cache_dependencies() override;
   virtual void init_action_list() override;
   void activate() override;
   virtual expr_t* create_expression( const std::string& name_str ) override;
@@ -8657,29 +8657,18 @@ double monk_t::passive_movement_modifier() const
   return ms;
 }
 
-// monk_t::invalidate_cache ==============================================
+// monk_t::init_cache_dependencies =======================================
 
-void monk_t::invalidate_cache( cache_e c )
+void monk_t::init_cache_dependencies()
 {
-  base_t::invalidate_cache( c );
+  base_t::init_cache_dependencies();
 
-  switch ( c )
-  {
-    case CACHE_SPELL_POWER:
-      if ( specialization() == MONK_MISTWEAVER )
-        player_t::invalidate_cache( CACHE_ATTACK_POWER );
-      break;
-    case CACHE_BONUS_ARMOR:
-      if ( spec.bladed_armor->ok() )
-        player_t::invalidate_cache( CACHE_ATTACK_POWER );
-      break;
-    case CACHE_MASTERY:
-      if ( specialization() == MONK_WINDWALKER )
-        player_t::invalidate_cache( CACHE_PLAYER_DAMAGE_MULTIPLIER );
-      break;
-    default:
-      break;
-  }
+  if ( specialization() == MONK_MISTWEAVER )
+    cache.add_dependency( CACHE_SPELL_POWER, CACHE_ATTACK_POWER );
+  if ( spec.bladed_armor->ok() )
+    cache.add_dependency( CACHE_BONUS_ARMOR, CACHE_ATTACK_POWER );
+  if ( specialization() == MONK_WINDWALKER )
+    cache.add_dependency( CACHE_MASTERY, CACHE_PLAYER_DAMAGE_MULTIPLIER );
 }
 
 // monk_t::create_options ===================================================
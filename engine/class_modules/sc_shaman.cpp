@@ -693,7 +693,7 @@ public:
   void init_special_effects() override;
 
   void moving() override;
-  void invalidate_cache( cache_e c ) override;
+  void init_cache_dependencies() override;
   double temporary_movement_modifier() const override;
   double passive_movement_modifier() const override;
   double composite_melee_crit_chance() const override;
@@ -8137,29 +8137,20 @@ double shaman_t::composite_player_pet_damage_multiplier( const action_state_t* s
   return m;
 }
 
-// shaman_t::invalidate_cache ===============================================
+// shaman_t::init_cache_dependencies ========================================
 
-void shaman_t::invalidate_cache( cache_e c )
+void shaman_t::init_cache_dependencies()
 {
-  player_t::invalidate_cache( c );
+  player_t::init_cache_dependencies();
 
-  switch ( c )
+  if ( specialization() == SHAMAN_ENHANCEMENT )
   {
-    case CACHE_AGILITY:
-    case CACHE_STRENGTH:
-    case CACHE_ATTACK_POWER:
-      if ( specialization() == SHAMAN_ENHANCEMENT )
-        player_t::invalidate_cache( CACHE_SPELL_POWER );
-      break;
-    case CACHE_MASTERY:
-      if ( mastery.enhanced_elements->ok() )
-      {
-        player_t::invalidate_cache( CACHE_PLAYER_DAMAGE_MULTIPLIER );
-      }
-      break;
-    default:
-      break;
+    cache.add_dependency( CACHE_AGILITY, CACHE_SPELL_POWER );
+    cache.add_dependency( CACHE_STRENGTH, CACHE_SPELL_POWER );
+    cache.add_dependency( CACHE_ATTACK_POWER, CACHE_SPELL_POWER );
   }
+  if ( mastery.enhanced_elements->ok() )
+    cache.add_dependency( CACHE_MASTERY, CACHE_PLAYER_DAMAGE_MULTIPLIER );
 }
 
 // shaman_t::arise() ========================================================
@@ -531,7 +531,7 @@ public:
   void moving() override;
   void create_options() override;
   std::string create_profile( save_e type ) override;
-  void invalidate_cache( cache_e ) override;
+  void init_cache_dependencies() override;
   double temporary_movement_modifier() const override;
 
   void default_apl_dps_precombat();
@@ -6372,29 +6372,21 @@ double warrior_t::temporary_movement_modifier() const
   return temporary;
 }
 
-// warrior_t::invalidate_cache ==============================================
+// warrior_t::init_cache_dependencies =======================================
 
-void warrior_t::invalidate_cache( cache_e c )
+void warrior_t::init_cache_dependencies()
 {
-  player_t::invalidate_cache( c );
+  player_t::init_cache_dependencies();
 
   if ( mastery.critical_block->ok() )
   {
-    if ( c == CACHE_MASTERY )
-    {
-      player_t::invalidate_cache( CACHE_BLOCK );
-      player_t::invalidate_cache( CACHE_CRIT_BLOCK );
-      player_t::invalidate_cache( CACHE_ATTACK_POWER );
-    }
-    if ( c == CACHE_CRIT_CHANCE )
-    {
-      player_t::invalidate_cache( CACHE_PARRY );
-    }
-  }
-  if ( c == CACHE_MASTERY && mastery.unshackled_fury->ok() )
-  {
-    player_t::invalidate_cache( CACHE_PLAYER_DAMAGE_MULTIPLIER );
+    cache.add_dependency( CACHE_MASTERY, CACHE_BLOCK );
+    cache.add_dependency( CACHE_MASTERY, CACHE_CRIT_BLOCK );
+    cache.add_dependency( CACHE_MASTERY, CACHE_ATTACK_POWER );
+    cache.add_dependency( CACHE_CRIT_CHANCE, CACHE_PARRY );
   }
+  if ( mastery.unshackled_fury->ok() )
+    cache.add_dependency( CACHE_MASTERY, CACHE_PLAYER_DAMAGE_MULTIPLIER );
 }
 
 // warrior_t::primary_role() ================================================
@@ -216,19 +216,12 @@ warlock_t::warlock_t( sim_t* sim, const std::string& name, race_e r ):
     regen_caches[CACHE_SPELL_HASTE] = true;
   }
 
-void warlock_t::invalidate_cache( cache_e c )
+void warlock_t::init_cache_dependencies()
 {
-  player_t::invalidate_cache( c );
+  player_t::init_cache_dependencies();
 
-  switch ( c )
-  {
-  case CACHE_MASTERY:
-    if ( mastery_spells.master_demonologist->ok() )
-      player_t::invalidate_cache( CACHE_PLAYER_DAMAGE_MULTIPLIER );
-    break;
-
-  default: break;
-  }
+  if ( mastery_spells.master_demonologist->ok() )
+    cache.add_dependency( CACHE_MASTERY, CACHE_PLAYER_DAMAGE_MULTIPLIER );
 }
 
 double warlock_t::composite_player_target_multiplier( player_t* target, school_e school ) const
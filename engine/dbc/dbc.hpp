@@ -239,6 +239,9 @@ namespace hotfix
 
     ~custom_dbc_data_t();
 
+    // Releases all custom data, and the driver links made for the cloned spells
+    void clear();
+
     bool add_spell( spell_data_t* spell, bool ptr = false );
     spell_data_t* get_mutable_spell( unsigned spell_id, bool ptr = false );
     const spell_data_t* find_spell( unsigned spell_id, bool ptr = false ) const;
@@ -421,6 +424,10 @@ namespace dbc_override
   const spelleffect_data_t* find_power( unsigned, bool ptr = false );
 
   const std::vector<dbc_override_entry_t>& override_entries();
+
+  // Removes all overrides, restoring the data they were made against. No object may be using
+  // overridden data when this is called.
+  void clear();
 }
 
 // ==========================================================================
@@ -1766,6 +1773,31 @@ struct id_compare
   { return KeyPolicy::id( *l ) < KeyPolicy::id( *r ); }
 };
 
+/* Perfect hash from ids to positions in a data array, generated by dbc_extract3 ( output_id_hash
+ * in dbc/generator.py ). An id hashes with seed 0 to a bucket, and with the seed of the bucket to a
+ * slot holding its position. Slots not holding any id hold the position of the terminating entry.
+ */
+struct dbc_hash_table_t
+{
+  unsigned size; // number of entries, excluding the terminating entry
+  const unsigned* seeds;
+  unsigned n_buckets; // power of two
+  const unsigned* slots;
+  unsigned n_slots; // power of two
+};
+
+// Must match dbc_hash() in dbc_extract3/dbc/generator.py
+inline unsigned dbc_hash( unsigned id, unsigned seed )
+{
+  uint32_t x = id ^ seed;
+  x ^= x >> 16;
+  x *= 0x7feb352dU;
+  x ^= x >> 15;
+  x *= 0x846ca68bU;
+  x ^= x >> 16;
+  return x;
+}
+
 template <typename T, typename KeyPolicy = id_function_policy>
 class dbc_index_t
 {
@@ -1774,8 +1806,10 @@ private:
 // array of size 1 or 2, depending on whether we have PTR data
 #if SC_USE_PTR == 0
   index_t idx[ 1 ];
+  dbc_hash_table_t hash[ 1 ];
 #else
   index_t idx[ 2 ];
+  dbc_hash_table_t hash[ 2 ];
 #endif
 
   /* populate idx with pointer to lowest and highest data from a given list
@@ -1798,6 +1832,16 @@ public:
   {
     assert( ! initialized( maybe_ptr( ptr ) ) );
     populate( idx[ maybe_ptr( ptr ) ], list );
+    hash[ maybe_ptr( ptr ) ] = dbc_hash_table_t();
+  }
+
+  // Initialize index from given list and its generated perfect hash, without scanning the list
+  void init( T* list, const dbc_hash_table_t& table, bool ptr )
+  {
+    assert( ! initialized( maybe_ptr( ptr ) ) );
+    assert( KeyPolicy::id( list[ table.size ] ) == 0 );
+    idx[ maybe_ptr( ptr ) ] = index_t( list, list + table.size );
+    hash[ maybe_ptr( ptr ) ] = table;
   }
 
   // Initialize index under the assumption that 'T::list( bool ptr )' returns a list of data
@@ -1815,7 +1859,18 @@ public:
   T* get( bool ptr, unsigned id ) const
   {
     assert( initialized( maybe_ptr( ptr ) ) );
-    T* p = std::lower_bound( idx[ maybe_ptr( ptr ) ].first, idx[ maybe_ptr( ptr ) ].second, id, id_compare<T, KeyPolicy>() );
+    const dbc_hash_table_t& h = hash[ maybe_ptr( ptr ) ];
+    T* p;
+    if ( h.slots )
+    {
+      unsigned seed = h.seeds[ dbc_hash( id, 0 ) & ( h.n_buckets - 1 ) ];
+      p = idx[ maybe_ptr( ptr ) ].first + h.slots[ dbc_hash( id, seed ) & ( h.n_slots - 1 ) ];
+    }
+    else
+    {
+      p = std::lower_bound( idx[ maybe_ptr( ptr ) ].first, idx[ maybe_ptr( ptr ) ].second, id, id_compare<T, KeyPolicy>() );
+    }
+
     if ( p != idx[ maybe_ptr( ptr ) ].second && KeyPolicy::id( *p ) == id )
       return p;
     else
@@ -28,6 +28,117 @@ dbc_index_t<spelleffect_data_t> spelleffect_data_index;
 dbc_index_t<talent_data_t> talent_data_index;
 dbc_index_t<spellpower_data_t> power_data_index;
 
+// Hash index from names to the entries of a data list, built on first use. Entries sharing a name
+// are chained in list order, so lookups find the same entry as a linear scan of the list.
+template <typename T>
+class dbc_name_index_t
+{
+  static const unsigned npos = ~0u;
+
+  T* list;
+  // One based position of the first entry of each key
+  std::unordered_map<std::string, unsigned> first;
+  // Position of the next entry with the same key
+  std::vector<unsigned> next;
+
+public:
+  // key_fn returns the key of an entry
+  template <typename KeyFn>
+  dbc_name_index_t( T* l, KeyFn key_fn ) : list( l )
+  {
+    unsigned n = 0;
+    while ( list[ n ].name_cstr() )
+    {
+      n++;
+    }
+
+    // Insert back to front, so every name maps to its first entry
+    next.assign( n, npos );
+    first.reserve( n );
+    for ( unsigned i = n; i > 0; --i )
+    {
+      auto& head = first[ key_fn( list[ i - 1 ] ) ];
+      next[ i - 1 ] = head != 0 ? head - 1 : npos;
+      head = i;
+    }
+  }
+
+  // First entry with the given key, for which pred returns true
+  template <typename Predicate>
+  T* find( const std::string& key, Predicate pred ) const
+  {
+    auto it = first.find( key );
+    if ( it == first.end() )
+    {
+      return nullptr;
+    }
+
+    for ( unsigned i = it -> second - 1; i != npos; i = next[ i ] )
+    {
+      if ( pred( list[ i ] ) )
+      {
+        return &list[ i ];
+      }
+    }
+
+    return nullptr;
+  }
+};
+
+template <typename T>
+const unsigned dbc_name_index_t<T>::npos;
+
+std::string tokenized_key( const char* name )
+{
+  std::string key = name;
+  util::tokenize( key );
+  return key;
+}
+
+// Function local statics, so the indices are built once on first use, also when the first use
+// comes from several threads at the same time
+const dbc_name_index_t<spell_data_t>& spell_name_index( bool ptr )
+{
+  if ( maybe_ptr( ptr ) )
+  {
+    static const dbc_name_index_t<spell_data_t> index( spell_data_t::list( true ),
+        []( const spell_data_t& s ) { return std::string( s.name_cstr() ); } );
+    return index;
+  }
+
+  static const dbc_name_index_t<spell_data_t> index( spell_data_t::list( false ),
+      []( const spell_data_t& s ) { return std::string( s.name_cstr() ); } );
+  return index;
+}
+
+const dbc_name_index_t<talent_data_t>& talent_name_index( bool ptr )
+{
+  if ( maybe_ptr( ptr ) )
+  {
+    static const dbc_name_index_t<talent_data_t> index( talent_data_t::list( true ),
+        []( const talent_data_t& t ) { return std::string( t.name_cstr() ); } );
+    return index;
+  }
+
+  static const dbc_name_index_t<talent_data_t> index( talent_data_t::list( false ),
+      []( const talent_data_t& t ) { return std::string( t.name_cstr() ); } );
+  return index;
+}
+
+const dbc_name_index_t<talent_data_t>& talent_tokenized_name_index( bool ptr )
+{
+  if ( maybe_ptr( ptr ) )
+  {
+    static const dbc_name_index_t<talent_data_t> index( talent_data_t::list( true ),
+        []( const talent_data_t& t ) { return tokenized_key( t.name_cstr() ); } );
+    return index;
+  }
+
+  static const dbc_name_index_t<talent_data_t> index( talent_data_t::list( false ),
+      []( const talent_data_t& t ) { return tokenized_key( t.name_cstr() ); } );
+  return index;
+}
+
 // Wrapper class to map other data to specific spells, and also to map effects that manipulate that
 // data
 template <typename T, typename V>
@@ -288,11 +399,37 @@ static void generate_class_flags_index( bool ptr = false )
  */
 void dbc::init()
 {
-  // Create id-indexes
-  spell_data_index.init();
-  spelleffect_data_index.init();
+  // Create id-indexes. Spell, effect and power data generated with perfect hash tables are
+  // indexed through them, older generated data falls back to binary searches.
+#if defined( SPELL_HASH_SIZE )
+  spell_data_index.init( __spell_data, { SPELL_HASH_SIZE,
+      __spell_hash_seeds, SPELL_HASH_BUCKETS, __spell_hash_slots, SPELL_HASH_SLOTS }, false );
+  spelleffect_data_index.init( __spelleffect_data, { SPELLEFFECT_HASH_SIZE,
+      __spelleffect_hash_seeds, SPELLEFFECT_HASH_BUCKETS, __spelleffect_hash_slots, SPELLEFFECT_HASH_SLOTS }, false );
+  power_data_index.init( __spellpower_data, { SPELLPOWER_HASH_SIZE,
+      __spellpower_hash_seeds, SPELLPOWER_HASH_BUCKETS, __spellpower_hash_slots, SPELLPOWER_HASH_SLOTS }, false );
+#else
+  spell_data_index.init( spell_data_t::list( false ), false );
+  spelleffect_data_index.init( spelleffect_data_t::list( false ), false );
+  power_data_index.init( spellpower_data_t::list( false ), false );
+#endif
+
+#if SC_USE_PTR
+#if defined( PTR_SPELL_HASH_SIZE )
+  spell_data_index.init( __ptr_spell_data, { PTR_SPELL_HASH_SIZE,
+      __ptr_spell_hash_seeds, PTR_SPELL_HASH_BUCKETS, __ptr_spell_hash_slots, PTR_SPELL_HASH_SLOTS }, true );
+  spelleffect_data_index.init( __ptr_spelleffect_data, { PTR_SPELLEFFECT_HASH_SIZE,
+      __ptr_spelleffect_hash_seeds, PTR_SPELLEFFECT_HASH_BUCKETS, __ptr_spelleffect_hash_slots, PTR_SPELLEFFECT_HASH_SLOTS }, true );
+  power_data_index.init( __ptr_spellpower_data, { PTR_SPELLPOWER_HASH_SIZE,
+      __ptr_spellpower_hash_seeds, PTR_SPELLPOWER_HASH_BUCKETS, __ptr_spellpower_hash_slots, PTR_SPELLPOWER_HASH_SLOTS }, true );
+#else
+  spell_data_index.init( spell_data_t::list( true ), true );
+  spelleffect_data_index.init( spelleffect_data_t::list( true ), true );
+  power_data_index.init( spellpower_data_t::list( true ), true );
+#endif
+#endif
+
   talent_data_index.init();
-  power_data_index.init();
   init_item_data();
 
   // runtime linking, eg. from spell_data to all its effects
@@ -1920,14 +2057,7 @@ spell_data_t* spell_data_t::find( unsigned spell_id, const char* confirmation, b
 
 spell_data_t* spell_data_t::find( const char* name, bool ptr )
 {
-  for ( spell_data_t* p = spell_data_t::list( ptr ); p -> name_cstr(); ++p )
-  {
-    if ( ! strcmp ( name, p -> name_cstr() ) )
-    {
-      return p;
-    }
-  }
-  return nullptr;
+  return spell_name_index( ptr ).find( name, []( const spell_data_t& ) { return true; } );
 }
 
 // Always returns non-NULL
@@ -1998,28 +2128,20 @@ talent_data_t* talent_data_t::find( unsigned id, const char* confirmation, bool
 
 talent_data_t* talent_data_t::find( const char* name_cstr, specialization_e spec, bool ptr )
 {
-  for ( talent_data_t* p = talent_data_t::list( ptr ); p -> name_cstr(); ++p )
-  {
-    if ( ! strcmp( name_cstr, p -> name_cstr() ) && p -> specialization() == spec )
-    {
-      return p;
-    }
-  }
-
-  return nullptr;
+  return talent_name_index( ptr ).find( name_cstr, [ spec ]( const talent_data_t& t ) {
+    return t.specialization() == spec;
+  } );
 }
 
 talent_data_t* talent_data_t::find_tokenized( const char* name, specialization_e spec, bool ptr )
 {
-  for ( talent_data_t* p = talent_data_t::list( ptr ); p -> name_cstr(); ++p )
-  {
-    std::string tokenized_name = p -> name_cstr();
-    util::tokenize( tokenized_name );
-    if ( util::str_compare_ci( name, tokenized_name ) && p -> specialization() == spec )
-      return p;
-  }
+  // Tokenized names are lower case, the comparison is case insensitive
+  std::string key = name;
+  util::tolower( key );
 
-  return nullptr;
+  return talent_tokenized_name_index( ptr ).find( key, [ spec ]( const talent_data_t& t ) {
+    return t.specialization() == spec;
+  } );
 }
 
 void spell_data_t::link( bool ptr )
@@ -878,6 +878,11 @@ spell_data_t* custom_dbc_data_t::clone_spell( unsigned clone_spell_id, bool ptr
 }
 
 custom_dbc_data_t::~custom_dbc_data_t()
+{
+  clear();
+}
+
+void custom_dbc_data_t::clear()
 {
   for ( size_t i = 0; i < spells_[ 0 ].size(); ++i )
   {
@@ -902,6 +907,13 @@ custom_dbc_data_t::~custom_dbc_data_t()
     } );
     delete spells_[ 1 ][ i ] -> _effects;
   }
+
+  for ( size_t i = 0; i < 2; ++i )
+  {
+    spells_[ i ].dispose();
+    effects_[ i ].dispose();
+    powers_[ i ].dispose();
+  }
 }
 
 namespace dbc_override
@@ -983,3 +995,9 @@ const spelleffect_data_t* dbc_override::find_effect( unsigned effect_id, bool pt
 const std::vector<dbc_override::dbc_override_entry_t>& dbc_override::override_entries()
 { return override_entries_; }
 
+void dbc_override::clear()
+{
+  override_db_.clear();
+  override_entries_.clear();
+}
+
@@ -842,6 +842,7 @@ player_t::player_t( sim_t* s, player_e t, const std::string& n, race_e r ) :
   {
     cache.active = sim->stat_cache != 0;
   }
+  cache.monitor = sim->monitor_stat_cache;
   if ( is_pet() )
     current.skill = 1.0;
 
@@ -1486,6 +1487,7 @@ void player_t::init_defense()
   if ( !is_pet() && primary_role() == ROLE_TANK )
   {
     collected_data.health_changes.collect = true;
+    collected_data.health_changes.keep_iteration_timeline = !tmi_debug_file_str.empty();
     collected_data.health_changes.set_bin_size( sim->tmi_bin_size );
     collected_data.health_changes_tmi.collect = true;
     collected_data.health_changes_tmi.set_bin_size( sim->tmi_bin_size );
@@ -2381,7 +2383,8 @@ void player_t::create_actions()
     }
   }
 
-  if ( !is_add() && ( !is_pet() || sim->report_pets_separately ) )
+  if ( !is_add() && ( !is_pet() || sim->report_pets_separately ) && sim->thread_index == 0 &&
+       sim->sequence_iteration != sim_t::SEQUENCE_NONE )
   {
     int capacity = std::max( 1200, static_cast<int>( sim->max_time.total_seconds() / 2.0 ) );
     collected_data.action_sequence.reserve( capacity );
@@ -2547,6 +2550,8 @@ void player_t::init_assessors()
 
 void player_t::init_finished()
 {
+  init_cache_dependencies();
+
   for ( auto action : action_list )
   {
     try
@@ -3780,6 +3785,8 @@ double player_t::composite_mastery_value() const
 
 /**
  * Invalidate a stat cache, resulting in re-calculation of the composite stat value.
+ *
+ * Dependent caches are invalidated through the dependency graph of the stat cache.
  */
 void player_t::invalidate_cache( cache_e c )
 {
@@ -3789,87 +3796,70 @@ void player_t::invalidate_cache( cache_e c )
   if ( sim->debug )
     sim->out_debug.printf( "%s invalidates %s", name(), util::cache_type_string( c ) );
 
-  // Special linked invalidations
-  switch ( c )
-  {
-    case CACHE_STRENGTH:
-      if ( current.attack_power_per_strength > 0 )
-        invalidate_cache( CACHE_ATTACK_POWER );
-      if ( current.parry_per_strength > 0 )
-        invalidate_cache( CACHE_PARRY );
-      break;
-    case CACHE_AGILITY:
-      if ( current.attack_power_per_agility > 0 )
-        invalidate_cache( CACHE_ATTACK_POWER );
-      if ( current.dodge_per_agility > 0 )
-        invalidate_cache( CACHE_DODGE );
-      if ( current.spell_power_per_attack_power > 0 )
-      {
-        invalidate_cache( CACHE_SPELL_POWER );
-        invalidate_cache( CACHE_ATTACK_POWER );
-      }
-      break;
-    case CACHE_INTELLECT:
-      if ( current.spell_power_per_intellect > 0 )
-        invalidate_cache( CACHE_SPELL_POWER );
-      break;
-    case CACHE_ATTACK_HASTE:
-      invalidate_cache( CACHE_ATTACK_SPEED );
-      break;
-    case CACHE_SPELL_HASTE:
-      invalidate_cache( CACHE_SPELL_SPEED );
-      break;
-    case CACHE_BONUS_ARMOR:
-      invalidate_cache( CACHE_ARMOR );
-      break;
-    default:
-      break;
-  }
+  cache.invalidate( c );
+}
 
-  // Normal invalidation of the corresponding Cache
-  switch ( c )
+/**
+ * Declare the dependencies between stat caches that are decided by the initial stats of the
+ * actor. Called once the actor is fully initialized, class modules add their own (eg. mastery
+ * invalidates the player damage multiplier) after calling the base implementation.
+ */
+void player_t::init_cache_dependencies()
+{
+  if ( initial.attack_power_per_strength > 0 )
+    cache.add_dependency( CACHE_STRENGTH, CACHE_ATTACK_POWER );
+  if ( initial.parry_per_strength > 0 )
+    cache.add_dependency( CACHE_STRENGTH, CACHE_PARRY );
+  if ( initial.attack_power_per_agility > 0 )
+    cache.add_dependency( CACHE_AGILITY, CACHE_ATTACK_POWER );
+  if ( initial.dodge_per_agility > 0 )
+    cache.add_dependency( CACHE_AGILITY, CACHE_DODGE );
+  if ( initial.spell_power_per_attack_power > 0 )
   {
-    case CACHE_EXP:
-      invalidate_cache( CACHE_ATTACK_EXP );
-      invalidate_cache( CACHE_SPELL_HIT );
-      break;
-    case CACHE_HIT:
-      invalidate_cache( CACHE_ATTACK_HIT );
-      invalidate_cache( CACHE_SPELL_HIT );
-      break;
-    case CACHE_CRIT_CHANCE:
-      invalidate_cache( CACHE_ATTACK_CRIT_CHANCE );
-      invalidate_cache( CACHE_SPELL_CRIT_CHANCE );
-      break;
-    case CACHE_HASTE:
-      invalidate_cache( CACHE_ATTACK_HASTE );
-      invalidate_cache( CACHE_SPELL_HASTE );
-      break;
-    case CACHE_SPEED:
-      invalidate_cache( CACHE_ATTACK_SPEED );
-      invalidate_cache( CACHE_SPELL_SPEED );
-      break;
-    case CACHE_VERSATILITY:
-      invalidate_cache( CACHE_DAMAGE_VERSATILITY );
-      invalidate_cache( CACHE_HEAL_VERSATILITY );
-      invalidate_cache( CACHE_MITIGATION_VERSATILITY );
-      break;
-    default:
-      cache.invalidate( c );
-      break;
+    cache.add_dependency( CACHE_AGILITY, CACHE_SPELL_POWER );
+    cache.add_dependency( CACHE_AGILITY, CACHE_ATTACK_POWER );
   }
+  if ( initial.spell_power_per_intellect > 0 )
+    cache.add_dependency( CACHE_INTELLECT, CACHE_SPELL_POWER );
 }
 #else
 void invalidate_cache( cache_e )
 {
 }
+
+void player_t::init_cache_dependencies()
+{
+}
 #endif
 
+namespace
+{
+// Only the main thread records the sample sequence. By default it records iteration#1, for
+// log/debug/iterations==1 simulation (or a replayed iteration) iteration#0.
+bool record_sequence( const player_t& p )
+{
+  const sim_t& sim = *p.sim;
+
+  if ( sim.thread_index != 0 )
+  {
+    return false;
+  }
+
+  switch ( sim.sequence_iteration )
+  {
+    case sim_t::SEQUENCE_FIRST:
+      return ( sim.iterations <= 1 && sim.current_iteration == 0 ) || ( sim.iterations > 1 && p.nth_iteration() == 1 );
+    case sim_t::SEQUENCE_LAST:
+      return true;
+    default:
+      return false;
+  }
+}
+}  // namespace
+
 void player_t::sequence_add_wait( const timespan_t& amount, const timespan_t& ts )
 {
-  // Collect iteration#1 data, for log/debug/iterations==1 simulation iteration#0 data
-  if ( ( sim->iterations <= 1 && sim->current_iteration == 0 ) ||
-       ( sim->iterations > 1 && nth_iteration() == 1 ) )
+  if ( record_sequence( *this ) )
   {
     if ( collected_data.action_sequence.size() <= sim->expected_max_time() * 2.0 + 3.0 )
     {
@@ -3879,7 +3869,7 @@ void player_t::sequence_add_wait( const timespan_t& amount, const timespan_t& ts
              collected_data.action_sequence.back().wait_time > timespan_t::zero() )
           collected_data.action_sequence.back().wait_time += amount;
         else
-          collected_data.action_sequence.emplace_back( ts, amount, this );
+          collected_data.sequence_append( collected_data.action_sequence, nullptr, nullptr, ts, amount, this );
       }
     }
     else
@@ -3894,16 +3884,15 @@ void player_t::sequence_add_wait( const timespan_t& amount, const timespan_t& ts
 
 void player_t::sequence_add( const action_t* a, const player_t* target, const timespan_t& ts )
 {
-  // Collect iteration#1 data, for log/debug/iterations==1 simulation iteration#0 data
-  if ( ( a->sim->iterations <= 1 && a->sim->current_iteration == 0 ) ||
-       ( a->sim->iterations > 1 && nth_iteration() == 1 ) )
+  if ( record_sequence( *this ) )
   {
     if ( collected_data.action_sequence.size() <= sim->expected_max_time() * 2.0 + 3.0 )
     {
       if ( in_combat )
-        collected_data.action_sequence.emplace_back( a, target, ts, this );
+        collected_data.sequence_append( collected_data.action_sequence, a, target, ts, timespan_t::zero(), this );
       else
-        collected_data.action_sequence_precombat.emplace_back( a, target, ts, this );
+        collected_data.sequence_append( collected_data.action_sequence_precombat, a, target, ts, timespan_t::zero(),
+                                        this );
     }
     else
     {
@@ -3927,6 +3916,24 @@ void player_t::combat_begin()
 
   init_resources( true );
 
+  // Regression scale factor sims perturb each scaled stat by a random +-delta every iteration
+  if ( scaling && scale_player && !is_pet() && !is_enemy() && !sim->scaling->regression_stats.empty() )
+  {
+    scaling->iteration_offsets.clear();
+    for ( auto stat : sim->scaling->regression_stats )
+    {
+      double delta  = sim->scaling->stats.get_stat( stat );
+      double offset = rng().roll( 0.5 ) ? delta : -delta;
+
+      if ( offset > 0 )
+        stat_gain( stat, offset );
+      else
+        stat_loss( stat, -offset );
+
+      scaling->iteration_offsets.push_back( offset );
+    }
+  }
+
   // Execute pre-combat actions
   if ( !is_pet() && !is_add() )
   {
@@ -4140,9 +4147,9 @@ void player_t::datacollection_end()
   {
     collected_data.timeline_healing_taken.add( sim->current_time(), 0.0 );
     collected_data.timeline_dmg_taken.add( sim->current_time(), 0.0 );
-    collected_data.health_changes.timeline.add( sim->current_time(), 0.0 );
+    collected_data.health_changes.add( sim->current_time(), 0.0 );
     collected_data.health_changes.timeline_normalized.add( sim->current_time(), 0.0 );
-    collected_data.health_changes_tmi.timeline.add( sim->current_time(), 0.0 );
+    collected_data.health_changes_tmi.add( sim->current_time(), 0.0 );
     collected_data.health_changes_tmi.timeline_normalized.add( sim->current_time(), 0.0 );
   }
   collected_data.collect_data( *this );
@@ -4199,6 +4206,7 @@ const char* source_name( const buff_t& b )
 void prepare( player_t& p )
 {
   range::sort( p.buff_list, compare );
+  p.buff_index.clear();
   // For all i, p.buff_list[ i ] <= p.buff_list[ i + 1 ]
 
 #ifndef NDEBUG
@@ -4385,6 +4393,8 @@ void player_t::merge( player_t& other )
     }
   }
 
+  cache.merge_counters( other.cache );
+
   // Action Map
   size_t n_entries = std::min( action_list.size(), other.action_list.size() );
   if ( action_list.size() != other.action_list.size() )
@@ -4398,6 +4408,8 @@ void player_t::merge( player_t& other )
     if ( action_list[ i ]->internal_id == other.action_list[ i ]->internal_id )
     {
       action_list[ i ]->total_executions += other.action_list[ i ]->total_executions;
+      action_list[ i ]->if_cache_hits += other.action_list[ i ]->if_cache_hits;
+      action_list[ i ]->if_cache_misses += other.action_list[ i ]->if_cache_misses;
     }
     else
     {
@@ -4411,6 +4423,97 @@ void player_t::merge( player_t& other )
   }
 }
 
+namespace
+{
+size_t sequence_memory_size( const std::vector<player_collected_data_t::action_sequence_data_t>& sequence )
+{
+  size_t bytes = sequence.capacity() * sizeof( player_collected_data_t::action_sequence_data_t );
+  for ( const auto& entry : sequence )
+  {
+    bytes += entry.buff_list.capacity() * sizeof( entry.buff_list[ 0 ] );
+    for ( const auto& buff : entry.buff_list )
+      bytes += buff.second.capacity() * sizeof( double );
+
+    bytes += entry.cooldown_list.capacity() * sizeof( entry.cooldown_list[ 0 ] );
+    for ( const auto& cooldown : entry.cooldown_list )
+      bytes += cooldown.second.capacity() * sizeof( double );
+
+    bytes += entry.target_list.capacity() * sizeof( entry.target_list[ 0 ] );
+    for ( const auto& target : entry.target_list )
+    {
+      bytes += target.second.capacity() * sizeof( target.second[ 0 ] );
+      for ( const auto& buff : target.second )
+        bytes += buff.second.capacity() * sizeof( double );
+    }
+  }
+
+  return bytes;
+}
+}  // namespace
+
+/**
+ * Add the heap memory held by the player to the memory usage categories.
+ */
+void player_t::memory_usage( memory_usage_t::values_t& v ) const
+{
+  const auto& cd = collected_data;
+
+  size_t sample_data = 0;
+  for ( const extended_sample_data_t* sd : {
+          &cd.fight_length, &cd.waiting_time, &cd.pooling_time, &cd.executed_foreground_actions,
+          &cd.dmg, &cd.compound_dmg, &cd.prioritydps, &cd.dps, &cd.dpse, &cd.dtps, &cd.dmg_taken,
+          &cd.heal, &cd.compound_heal, &cd.hps, &cd.hpse, &cd.htps, &cd.heal_taken,
+          &cd.absorb, &cd.compound_absorb, &cd.aps, &cd.atps, &cd.absorb_taken,
+          &cd.deaths, &cd.theck_meloree_index, &cd.effective_theck_meloree_index,
+          &cd.max_spike_amount, &cd.target_metric } )
+  {
+    sample_data += sd->memory_size();
+  }
+  sample_data += cd.iteration_stream.capacity() * sizeof( uint64_t );
+  sample_data += cd.scale_offsets.capacity() * sizeof( double );
+  for ( const auto sd : sample_data_list )
+    sample_data += sd->memory_size();
+
+  size_t timelines = cd.timeline_dmg.memory_size() + cd.timeline_dmg_taken.memory_size() +
+                     cd.timeline_healing_taken.memory_size();
+  for ( const auto& tl : cd.resource_timelines )
+    timelines += tl.timeline.memory_size();
+  for ( const auto& tl : cd.stat_timelines )
+    timelines += tl.timeline.memory_size();
+  for ( const auto* hc : { &cd.health_changes, &cd.health_changes_tmi } )
+  {
+    timelines += hc->timeline.memory_size() + hc->timeline_normalized.memory_size() +
+                 hc->merged_timeline.memory_size();
+  }
+
+  for ( const auto stats : stats_list )
+  {
+    sample_data += stats->actual_amount.memory_size() + stats->total_amount.memory_size() +
+                   stats->portion_aps.memory_size() + stats->portion_apse.memory_size();
+    if ( stats->timeline_amount )
+      timelines += stats->timeline_amount->memory_size();
+  }
+
+  size_t buffs = 0;
+  for ( const auto buff : buff_list )
+  {
+    buffs += buff->memory_size();
+    timelines += buff->uptime_array.memory_size();
+  }
+
+  size_t action_states = 0;
+  for ( const auto action : action_list )
+    action_states += action->n_allocated_states() * sizeof( action_state_t );
+
+  v[ memory_usage_t::MEMORY_SAMPLE_DATA ] += sample_data;
+  v[ memory_usage_t::MEMORY_TIMELINES ] += timelines;
+  v[ memory_usage_t::MEMORY_ACTION_SEQUENCE ] += sequence_memory_size( cd.action_sequence ) +
+                                                 sequence_memory_size( cd.action_sequence_precombat ) +
+                                                 sequence_memory_size( cd.action_sequence_pool );
+  v[ memory_usage_t::MEMORY_BUFFS ] += buffs;
+  v[ memory_usage_t::MEMORY_ACTION_STATES ] += action_states;
+}
+
 /**
  * Reset player. Called after each iteration to reset the player to its initial state.
  */
@@ -4425,6 +4528,12 @@ void player_t::reset()
 
   cache.invalidate_all();
 
+  // Only the last recorded iteration is kept, its entries are reused for the next one
+  if ( sim->sequence_iteration == sim_t::SEQUENCE_LAST && record_sequence( *this ) )
+  {
+    collected_data.sequence_restart();
+  }
+
   // Reset current stats to initial stats
   current = initial;
 
@@ -5866,7 +5975,7 @@ void collect_dmg_taken_data( player_t& p, const action_state_t* s, double result
   if ( p.collected_data.health_changes.collect )
   {
     // health_changes covers everything, used for ETMI and other things
-    p.collected_data.health_changes.timeline.add( p.sim->current_time(), s->result_amount );
+    p.collected_data.health_changes.add( p.sim->current_time(), s->result_amount );
     p.collected_data.health_changes.timeline_normalized.add( p.sim->current_time(),
                                                              s->result_amount / p.resources.max[ RESOURCE_HEALTH ] );
 
@@ -5876,7 +5985,7 @@ void collect_dmg_taken_data( player_t& p, const action_state_t* s, double result
   if ( p.collected_data.health_changes_tmi.collect )
   {
     // health_changes_tmi ignores external effects (e.g. external absorbs), used for raw TMI
-    p.collected_data.health_changes_tmi.timeline.add( p.sim->current_time(), result_ignoring_external_absorbs );
+    p.collected_data.health_changes_tmi.add( p.sim->current_time(), result_ignoring_external_absorbs );
     p.collected_data.health_changes_tmi.timeline_normalized.add(
         p.sim->current_time(), result_ignoring_external_absorbs / p.resources.max[ RESOURCE_HEALTH ] );
   }
@@ -6075,7 +6184,7 @@ void player_t::assess_heal( school_e, dmg_e, action_state_t* s )
   {
     // health_changes and timeline_healing_taken record everything, accounting for overheal and so on
     collected_data.timeline_healing_taken.add( sim->current_time(), -( s->result_amount ) );
-    collected_data.health_changes.timeline.add( sim->current_time(), -( s->result_amount ) );
+    collected_data.health_changes.add( sim->current_time(), -( s->result_amount ) );
     double normalized =
         resources.max[ RESOURCE_HEALTH ] ? -( s->result_amount ) / resources.max[ RESOURCE_HEALTH ] : 0.0;
     collected_data.health_changes.timeline_normalized.add( sim->current_time(), normalized );
@@ -6083,7 +6192,7 @@ void player_t::assess_heal( school_e, dmg_e, action_state_t* s )
     // health_changes_tmi ignores external healing - use result_total to count player overhealing as effective healing
     if ( s->action->player == this || is_my_pet( s->action->player ) )
     {
-      collected_data.health_changes_tmi.timeline.add( sim->current_time(), -( s->result_total ) );
+      collected_data.health_changes_tmi.add( sim->current_time(), -( s->result_total ) );
       collected_data.health_changes_tmi.timeline_normalized.add(
           sim->current_time(), -( s->result_total ) / resources.max[ RESOURCE_HEALTH ] );
     }
@@ -6182,17 +6291,17 @@ pet_t* player_t::find_pet( const std::string& name ) const
 
 stats_t* player_t::find_stats( const std::string& name ) const
 {
-  return find_vector_member( stats_list, name );
+  return stats_index.find( stats_list, name );
 }
 
 gain_t* player_t::find_gain( const std::string& name ) const
 {
-  return find_vector_member( gain_list, name );
+  return gain_index.find( gain_list, name );
 }
 
 proc_t* player_t::find_proc( const std::string& name ) const
 {
-  return find_vector_member( proc_list, name );
+  return proc_index.find( proc_list, name );
 }
 
 luxurious_sample_data_t* player_t::find_sample_data( const std::string& name ) const
@@ -6212,12 +6321,21 @@ uptime_t* player_t::find_uptime( const std::string& name ) const
 
 cooldown_t* player_t::find_cooldown( const std::string& name ) const
 {
-  return find_vector_member( cooldown_list, name );
+  return cooldown_index.find( cooldown_list, name );
 }
 
 action_t* player_t::find_action( const std::string& name ) const
 {
-  return find_vector_member( action_list, name );
+  if ( action_t* a = action_index.find( action_list, name ) )
+    return a;
+
+  // Some actions rename themselves during initialization (e.g., use_item), confirm misses with a
+  // scan and reindex if a renamed action turns up
+  action_t* a = find_vector_member( action_list, name );
+  if ( a )
+    action_index.clear();
+
+  return a;
 }
 
 cooldown_t* player_t::get_cooldown( const std::string& name )
@@ -9647,7 +9765,7 @@ expr_t* player_t::create_expression( const std::string& expression_str )
     {
       // buff.buff_name.buff_property
       get_target_data( this );
-      buff_t* buff = buff_t::find_expressable( buff_list, splits[ 1 ], this );
+      buff_t* buff = buff_t::find_expressable( this, splits[ 1 ], this );
       if ( !buff )
         buff = buff_t::find( this, splits[ 1 ], this );  // Raid debuffs
       if ( buff )
@@ -10559,6 +10677,7 @@ void player_t::analyze( sim_t& s )
   range::for_each( buff_list, []( buff_t* b ) { b->analyze(); } );
 
   range::sort( stats_list, []( const stats_t* l, const stats_t* r ) { return l->name_str < r->name_str; } );
+  stats_index.clear();
 
   if ( quiet )
     return;
@@ -10971,6 +11090,74 @@ void player_t::do_update_movement( double yards )
   }
 }
 
+player_stat_cache_t::player_stat_cache_t( const player_t* p ) :
+  player( p ), active( false ), monitor( false )
+{
+  for ( size_t i = 0; i < dependents.size(); ++i )
+    dependents[ i ].set( i );
+
+  // Dependencies shared by all actors
+  add_dependency( CACHE_EXP, CACHE_ATTACK_EXP );
+  add_dependency( CACHE_EXP, CACHE_SPELL_HIT );
+  add_dependency( CACHE_HIT, CACHE_ATTACK_HIT );
+  add_dependency( CACHE_HIT, CACHE_SPELL_HIT );
+  add_dependency( CACHE_CRIT_CHANCE, CACHE_ATTACK_CRIT_CHANCE );
+  add_dependency( CACHE_CRIT_CHANCE, CACHE_SPELL_CRIT_CHANCE );
+  add_dependency( CACHE_HASTE, CACHE_ATTACK_HASTE );
+  add_dependency( CACHE_HASTE, CACHE_SPELL_HASTE );
+  add_dependency( CACHE_ATTACK_HASTE, CACHE_ATTACK_SPEED );
+  add_dependency( CACHE_SPELL_HASTE, CACHE_SPELL_SPEED );
+  add_dependency( CACHE_SPEED, CACHE_ATTACK_SPEED );
+  add_dependency( CACHE_SPEED, CACHE_SPELL_SPEED );
+  add_dependency( CACHE_VERSATILITY, CACHE_DAMAGE_VERSATILITY );
+  add_dependency( CACHE_VERSATILITY, CACHE_HEAL_VERSATILITY );
+  add_dependency( CACHE_VERSATILITY, CACHE_MITIGATION_VERSATILITY );
+  add_dependency( CACHE_BONUS_ARMOR, CACHE_ARMOR );
+
+  reset_counters();
+  invalidate_all();
+}
+
+/**
+ * Add an edge to the dependency graph, keeping the transitive closure up to date: every entry
+ * that invalidates c now also invalidates everything dependent invalidates.
+ */
+void player_stat_cache_t::add_dependency( cache_e c, cache_e dependent )
+{
+  const cache_set_t closure = dependents[ dependent ];
+  for ( auto& set : dependents )
+  {
+    if ( set.test( c ) )
+      set |= closure;
+  }
+
+  assert( !side_effects_reachable() && "Dependency reaches an entry with invalidate_cache side effects" );
+}
+
+/**
+ * Declare that the invalidate_cache override of the actor reacts to invalidations of c. The
+ * override does not run for entries invalidated through a dependency, so c must stay unreachable.
+ */
+void player_stat_cache_t::add_side_effect( cache_e c )
+{
+  side_effects.set( c );
+
+  assert( !side_effects_reachable() && "Dependency reaches an entry with invalidate_cache side effects" );
+}
+
+bool player_stat_cache_t::side_effects_reachable() const
+{
+  for ( size_t i = 0; i < dependents.size(); ++i )
+  {
+    cache_set_t reached = dependents[ i ] & side_effects;
+    reached.reset( i );
+    if ( reached.any() )
+      return true;
+  }
+
+  return false;
+}
+
 /**
  * Invalidate cache for ALL stats.
  */
@@ -10979,31 +11166,62 @@ void player_stat_cache_t::invalidate_all()
   if ( !active )
     return;
 
-  range::fill( valid, false );
-  range::fill( spell_power_valid, false );
-  range::fill( player_mult_valid, false );
-  range::fill( player_heal_mult_valid, false );
+  valid.reset();
+  spell_power_valid.reset();
+  player_mult_valid.reset();
+  player_heal_mult_valid.reset();
 }
 
 /**
- * Invalidate cache for a specific cache.
+ * Invalidate cache for a specific cache, and all caches depending on it.
  */
 void player_stat_cache_t::invalidate( cache_e c )
 {
-  switch ( c )
+  const cache_set_t& set = dependents[ c ];
+
+  if ( monitor )
   {
-    case CACHE_SPELL_POWER:
-      range::fill( spell_power_valid, false );
-      break;
-    case CACHE_PLAYER_DAMAGE_MULTIPLIER:
-      range::fill( player_mult_valid, false );
-      break;
-    case CACHE_PLAYER_HEAL_MULTIPLIER:
-      range::fill( player_heal_mult_valid, false );
-      break;
-    default:
-      valid[ c ] = false;
-      break;
+    for ( size_t i = 0; i < set.size(); ++i )
+    {
+      if ( !set.test( i ) )
+        continue;
+
+      bool was_valid;
+      switch ( i )
+      {
+        case CACHE_SPELL_POWER:              was_valid = spell_power_valid.any(); break;
+        case CACHE_PLAYER_DAMAGE_MULTIPLIER: was_valid = player_mult_valid.any(); break;
+        case CACHE_PLAYER_HEAL_MULTIPLIER:   was_valid = player_heal_mult_valid.any(); break;
+        default:                             was_valid = valid.test( i ); break;
+      }
+      if ( was_valid )
+        ++invalidations[ i ];
+    }
+  }
+
+  valid &= ~set;
+  if ( set.test( CACHE_SPELL_POWER ) )
+    spell_power_valid.reset();
+  if ( set.test( CACHE_PLAYER_DAMAGE_MULTIPLIER ) )
+    player_mult_valid.reset();
+  if ( set.test( CACHE_PLAYER_HEAL_MULTIPLIER ) )
+    player_heal_mult_valid.reset();
+}
+
+void player_stat_cache_t::reset_counters()
+{
+  range::fill( hits, 0 );
+  range::fill( recomputes, 0 );
+  range::fill( invalidations, 0 );
+}
+
+void player_stat_cache_t::merge_counters( const player_stat_cache_t& other )
+{
+  for ( size_t i = 0; i < hits.size(); ++i )
+  {
+    hits[ i ] += other.hits[ i ];
+    recomputes[ i ] += other.recomputes[ i ];
+    invalidations[ i ] += other.invalidations[ i ];
   }
 }
 
@@ -11035,7 +11253,7 @@ double player_stat_cache_t::get_attribute( attribute_e a ) const
 
 double player_stat_cache_t::strength() const
 {
-  if ( !active || !valid[ CACHE_STRENGTH ] )
+  if ( recompute( CACHE_STRENGTH, !valid[ CACHE_STRENGTH ] ) )
   {
     valid[ CACHE_STRENGTH ] = true;
     _strength               = player->strength();
@@ -11047,7 +11265,7 @@ double player_stat_cache_t::strength() const
 
 double player_stat_cache_t::agility() const
 {
-  if ( !active || !valid[ CACHE_AGILITY ] )
+  if ( recompute( CACHE_AGILITY, !valid[ CACHE_AGILITY ] ) )
   {
     valid[ CACHE_AGILITY ] = true;
     _agility               = player->agility();
@@ -11059,7 +11277,7 @@ double player_stat_cache_t::agility() const
 
 double player_stat_cache_t::stamina() const
 {
-  if ( !active || !valid[ CACHE_STAMINA ] )
+  if ( recompute( CACHE_STAMINA, !valid[ CACHE_STAMINA ] ) )
   {
     valid[ CACHE_STAMINA ] = true;
     _stamina               = player->stamina();
@@ -11071,7 +11289,7 @@ double player_stat_cache_t::stamina() const
 
 double player_stat_cache_t::intellect() const
 {
-  if ( !active || !valid[ CACHE_INTELLECT ] )
+  if ( recompute( CACHE_INTELLECT, !valid[ CACHE_INTELLECT ] ) )
   {
     valid[ CACHE_INTELLECT ] = true;
     _intellect               = player->intellect();
@@ -11083,7 +11301,7 @@ double player_stat_cache_t::intellect() const
 
 double player_stat_cache_t::spirit() const
 {
-  if ( !active || !valid[ CACHE_SPIRIT ] )
+  if ( recompute( CACHE_SPIRIT, !valid[ CACHE_SPIRIT ] ) )
   {
     valid[ CACHE_SPIRIT ] = true;
     _spirit               = player->spirit();
@@ -11095,7 +11313,7 @@ double player_stat_cache_t::spirit() const
 
 double player_stat_cache_t::spell_power( school_e s ) const
 {
-  if ( !active || !spell_power_valid[ s ] )
+  if ( recompute( CACHE_SPELL_POWER, !spell_power_valid[ s ] ) )
   {
     spell_power_valid[ s ] = true;
     _spell_power[ s ]      = player->composite_spell_power( s );
@@ -11107,7 +11325,7 @@ double player_stat_cache_t::spell_power( school_e s ) const
 
 double player_stat_cache_t::attack_power() const
 {
-  if ( !active || !valid[ CACHE_ATTACK_POWER ] )
+  if ( recompute( CACHE_ATTACK_POWER, !valid[ CACHE_ATTACK_POWER ] ) )
   {
     valid[ CACHE_ATTACK_POWER ] = true;
     _attack_power               = player->composite_melee_attack_power();
@@ -11119,7 +11337,7 @@ double player_stat_cache_t::attack_power() const
 
 double player_stat_cache_t::attack_expertise() const
 {
-  if ( !active || !valid[ CACHE_ATTACK_EXP ] )
+  if ( recompute( CACHE_ATTACK_EXP, !valid[ CACHE_ATTACK_EXP ] ) )
   {
     valid[ CACHE_ATTACK_EXP ] = true;
     _attack_expertise         = player->composite_melee_expertise();
@@ -11131,7 +11349,7 @@ double player_stat_cache_t::attack_expertise() const
 
 double player_stat_cache_t::attack_hit() const
 {
-  if ( !active || !valid[ CACHE_ATTACK_HIT ] )
+  if ( recompute( CACHE_ATTACK_HIT, !valid[ CACHE_ATTACK_HIT ] ) )
   {
     valid[ CACHE_ATTACK_HIT ] = true;
     _attack_hit               = player->composite_melee_hit();
@@ -11149,7 +11367,7 @@ double player_stat_cache_t::attack_hit() const
 
 double player_stat_cache_t::attack_crit_chance() const
 {
-  if ( !active || !valid[ CACHE_ATTACK_CRIT_CHANCE ] )
+  if ( recompute( CACHE_ATTACK_CRIT_CHANCE, !valid[ CACHE_ATTACK_CRIT_CHANCE ] ) )
   {
     valid[ CACHE_ATTACK_CRIT_CHANCE ] = true;
     _attack_crit_chance               = player->composite_melee_crit_chance();
@@ -11161,7 +11379,7 @@ double player_stat_cache_t::attack_crit_chance() const
 
 double player_stat_cache_t::attack_haste() const
 {
-  if ( !active || !valid[ CACHE_ATTACK_HASTE ] )
+  if ( recompute( CACHE_ATTACK_HASTE, !valid[ CACHE_ATTACK_HASTE ] ) )
   {
     valid[ CACHE_ATTACK_HASTE ] = true;
     _attack_haste               = player->composite_melee_haste();
@@ -11173,7 +11391,7 @@ double player_stat_cache_t::attack_haste() const
 
 double player_stat_cache_t::attack_speed() const
 {
-  if ( !active || !valid[ CACHE_ATTACK_SPEED ] )
+  if ( recompute( CACHE_ATTACK_SPEED, !valid[ CACHE_ATTACK_SPEED ] ) )
   {
     valid[ CACHE_ATTACK_SPEED ] = true;
     _attack_speed               = player->composite_melee_speed();
@@ -11185,7 +11403,7 @@ double player_stat_cache_t::attack_speed() const
 
 double player_stat_cache_t::spell_hit() const
 {
-  if ( !active || !valid[ CACHE_SPELL_HIT ] )
+  if ( recompute( CACHE_SPELL_HIT, !valid[ CACHE_SPELL_HIT ] ) )
   {
     valid[ CACHE_SPELL_HIT ] = true;
     _spell_hit               = player->composite_spell_hit();
@@ -11197,7 +11415,7 @@ double player_stat_cache_t::spell_hit() const
 
 double player_stat_cache_t::spell_crit_chance() const
 {
-  if ( !active || !valid[ CACHE_SPELL_CRIT_CHANCE ] )
+  if ( recompute( CACHE_SPELL_CRIT_CHANCE, !valid[ CACHE_SPELL_CRIT_CHANCE ] ) )
   {
     valid[ CACHE_SPELL_CRIT_CHANCE ] = true;
     _spell_crit_chance               = player->composite_spell_crit_chance();
@@ -11209,7 +11427,7 @@ double player_stat_cache_t::spell_crit_chance() const
 
 double player_stat_cache_t::spell_haste() const
 {
-  if ( !active || !valid[ CACHE_SPELL_HASTE ] )
+  if ( recompute( CACHE_SPELL_HASTE, !valid[ CACHE_SPELL_HASTE ] ) )
   {
     valid[ CACHE_SPELL_HASTE ] = true;
     _spell_haste               = player->composite_spell_haste();
@@ -11221,7 +11439,7 @@ double player_stat_cache_t::spell_haste() const
 
 double player_stat_cache_t::spell_speed() const
 {
-  if ( !active || !valid[ CACHE_SPELL_SPEED ] )
+  if ( recompute( CACHE_SPELL_SPEED, !valid[ CACHE_SPELL_SPEED ] ) )
   {
     valid[ CACHE_SPELL_SPEED ] = true;
     _spell_speed               = player->composite_spell_speed();
@@ -11233,7 +11451,7 @@ double player_stat_cache_t::spell_speed() const
 
 double player_stat_cache_t::dodge() const
 {
-  if ( !active || !valid[ CACHE_DODGE ] )
+  if ( recompute( CACHE_DODGE, !valid[ CACHE_DODGE ] ) )
   {
     valid[ CACHE_DODGE ] = true;
     _dodge               = player->composite_dodge();
@@ -11245,7 +11463,7 @@ double player_stat_cache_t::dodge() const
 
 double player_stat_cache_t::parry() const
 {
-  if ( !active || !valid[ CACHE_PARRY ] )
+  if ( recompute( CACHE_PARRY, !valid[ CACHE_PARRY ] ) )
   {
     valid[ CACHE_PARRY ] = true;
     _parry               = player->composite_parry();
@@ -11257,7 +11475,7 @@ double player_stat_cache_t::parry() const
 
 double player_stat_cache_t::block() const
 {
-  if ( !active || !valid[ CACHE_BLOCK ] )
+  if ( recompute( CACHE_BLOCK, !valid[ CACHE_BLOCK ] ) )
   {
     valid[ CACHE_BLOCK ] = true;
     _block               = player->composite_block();
@@ -11269,7 +11487,7 @@ double player_stat_cache_t::block() const
 
 double player_stat_cache_t::crit_block() const
 {
-  if ( !active || !valid[ CACHE_CRIT_BLOCK ] )
+  if ( recompute( CACHE_CRIT_BLOCK, !valid[ CACHE_CRIT_BLOCK ] ) )
   {
     valid[ CACHE_CRIT_BLOCK ] = true;
     _crit_block               = player->composite_crit_block();
@@ -11281,7 +11499,7 @@ double player_stat_cache_t::crit_block() const
 
 double player_stat_cache_t::crit_avoidance() const
 {
-  if ( !active || !valid[ CACHE_CRIT_AVOIDANCE ] )
+  if ( recompute( CACHE_CRIT_AVOIDANCE, !valid[ CACHE_CRIT_AVOIDANCE ] ) )
   {
     valid[ CACHE_CRIT_AVOIDANCE ] = true;
     _crit_avoidance               = player->composite_crit_avoidance();
@@ -11293,7 +11511,7 @@ double player_stat_cache_t::crit_avoidance() const
 
 double player_stat_cache_t::miss() const
 {
-  if ( !active || !valid[ CACHE_MISS ] )
+  if ( recompute( CACHE_MISS, !valid[ CACHE_MISS ] ) )
   {
     valid[ CACHE_MISS ] = true;
     _miss               = player->composite_miss();
@@ -11305,7 +11523,7 @@ double player_stat_cache_t::miss() const
 
 double player_stat_cache_t::armor() const
 {
-  if ( !active || !valid[ CACHE_ARMOR ] || !valid[ CACHE_BONUS_ARMOR ] )
+  if ( recompute( CACHE_ARMOR, !valid[ CACHE_ARMOR ] || !valid[ CACHE_BONUS_ARMOR ] ) )
   {
     valid[ CACHE_ARMOR ] = true;
     _armor               = player->composite_armor();
@@ -11317,7 +11535,7 @@ double player_stat_cache_t::armor() const
 
 double player_stat_cache_t::mastery() const
 {
-  if ( !active || !valid[ CACHE_MASTERY ] )
+  if ( recompute( CACHE_MASTERY, !valid[ CACHE_MASTERY ] ) )
   {
     valid[ CACHE_MASTERY ] = true;
     _mastery               = player->composite_mastery();
@@ -11335,7 +11553,7 @@ double player_stat_cache_t::mastery() const
  */
 double player_stat_cache_t::mastery_value() const
 {
-  if ( !active || !valid[ CACHE_MASTERY ] )
+  if ( recompute( CACHE_MASTERY, !valid[ CACHE_MASTERY ] ) )
   {
     valid[ CACHE_MASTERY ] = true;
     _mastery               = player->composite_mastery();
@@ -11348,7 +11566,7 @@ double player_stat_cache_t::mastery_value() const
 
 double player_stat_cache_t::bonus_armor() const
 {
-  if ( !active || !valid[ CACHE_BONUS_ARMOR ] )
+  if ( recompute( CACHE_BONUS_ARMOR, !valid[ CACHE_BONUS_ARMOR ] ) )
   {
     valid[ CACHE_BONUS_ARMOR ] = true;
     _bonus_armor               = player->composite_bonus_armor();
@@ -11360,7 +11578,7 @@ double player_stat_cache_t::bonus_armor() const
 
 double player_stat_cache_t::damage_versatility() const
 {
-  if ( !active || !valid[ CACHE_DAMAGE_VERSATILITY ] )
+  if ( recompute( CACHE_DAMAGE_VERSATILITY, !valid[ CACHE_DAMAGE_VERSATILITY ] ) )
   {
     valid[ CACHE_DAMAGE_VERSATILITY ] = true;
     _damage_versatility               = player->composite_damage_versatility();
@@ -11372,7 +11590,7 @@ double player_stat_cache_t::damage_versatility() const
 
 double player_stat_cache_t::heal_versatility() const
 {
-  if ( !active || !valid[ CACHE_HEAL_VERSATILITY ] )
+  if ( recompute( CACHE_HEAL_VERSATILITY, !valid[ CACHE_HEAL_VERSATILITY ] ) )
   {
     valid[ CACHE_HEAL_VERSATILITY ] = true;
     _heal_versatility               = player->composite_heal_versatility();
@@ -11384,7 +11602,7 @@ double player_stat_cache_t::heal_versatility() const
 
 double player_stat_cache_t::mitigation_versatility() const
 {
-  if ( !active || !valid[ CACHE_MITIGATION_VERSATILITY ] )
+  if ( recompute( CACHE_MITIGATION_VERSATILITY, !valid[ CACHE_MITIGATION_VERSATILITY ] ) )
   {
     valid[ CACHE_MITIGATION_VERSATILITY ] = true;
     _mitigation_versatility               = player->composite_mitigation_versatility();
@@ -11396,7 +11614,7 @@ double player_stat_cache_t::mitigation_versatility() const
 
 double player_stat_cache_t::leech() const
 {
-  if ( !active || !valid[ CACHE_LEECH ] )
+  if ( recompute( CACHE_LEECH, !valid[ CACHE_LEECH ] ) )
   {
     valid[ CACHE_LEECH ] = true;
     _leech               = player->composite_leech();
@@ -11408,7 +11626,7 @@ double player_stat_cache_t::leech() const
 
 double player_stat_cache_t::run_speed() const
 {
-  if ( !active || !valid[ CACHE_RUN_SPEED ] )
+  if ( recompute( CACHE_RUN_SPEED, !valid[ CACHE_RUN_SPEED ] ) )
   {
     valid[ CACHE_RUN_SPEED ] = true;
     _run_speed               = player->composite_movement_speed();
@@ -11420,7 +11638,7 @@ double player_stat_cache_t::run_speed() const
 
 double player_stat_cache_t::avoidance() const
 {
-  if ( !active || !valid[ CACHE_AVOIDANCE ] )
+  if ( recompute( CACHE_AVOIDANCE, !valid[ CACHE_AVOIDANCE ] ) )
   {
     valid[ CACHE_AVOIDANCE ] = true;
     _avoidance               = player->composite_avoidance();
@@ -11432,7 +11650,7 @@ double player_stat_cache_t::avoidance() const
 
 double player_stat_cache_t::player_multiplier( school_e s ) const
 {
-  if ( !active || !player_mult_valid[ s ] )
+  if ( recompute( CACHE_PLAYER_DAMAGE_MULTIPLIER, !player_mult_valid[ s ] ) )
   {
     player_mult_valid[ s ] = true;
     _player_mult[ s ]      = player->composite_player_multiplier( s );
@@ -11446,7 +11664,7 @@ double player_stat_cache_t::player_heal_multiplier( const action_state_t* s ) co
 {
   school_e sch = s->action->get_school();
 
-  if ( !active || !player_heal_mult_valid[ sch ] )
+  if ( recompute( CACHE_PLAYER_HEAL_MULTIPLIER, !player_heal_mult_valid[ sch ] ) )
   {
     player_heal_mult_valid[ sch ] = true;
     _player_heal_mult[ sch ]      = player->composite_player_heal_multiplier( s );
@@ -11458,58 +11676,100 @@ double player_stat_cache_t::player_heal_multiplier( const action_state_t* s ) co
 
 #endif
 
+namespace
+{
+// Entry index of a snapshot list, keyed by key. Reuses the memory of the entry a previous
+// snapshot left there.
+template <typename K, typename V>
+V& snapshot_entry( std::vector<std::pair<K, V>>& list, size_t index, K key )
+{
+  if ( index == list.size() )
+  {
+    list.emplace_back( key, V() );
+  }
+  else
+  {
+    list[ index ].first = key;
+  }
+
+  return list[ index ].second;
+}
+}  // namespace
+
 player_collected_data_t::action_sequence_data_t::action_sequence_data_t( const action_t* a, const player_t* t,
-                                                                         const timespan_t& ts, const player_t* p ) :
-  action( a ),
-  target( t ),
-  time( ts ),
-  wait_time( timespan_t::zero() )
+                                                                         const timespan_t& ts, const player_t* p )
 {
+  snapshot( a, t, ts, timespan_t::zero(), p );
+}
+
+player_collected_data_t::action_sequence_data_t::action_sequence_data_t( const timespan_t& ts, const timespan_t& wait,
+                                                                         const player_t* p )
+{
+  snapshot( nullptr, nullptr, ts, wait, p );
+}
+
+void player_collected_data_t::action_sequence_data_t::snapshot( const action_t* a, const player_t* t,
+                                                                const timespan_t& ts, const timespan_t& wait,
+                                                                const player_t* p )
+{
+  action    = a;
+  target    = t;
+  time      = ts;
+  wait_time = wait;
+
+  size_t n = 0;
   for ( size_t i = 0; i < p->buff_list.size(); ++i )
   {
     buff_t* b = p->buff_list[ i ];
     if ( b->check() && !b->quiet && !b->constant )
     {
-      std::vector<double> buff_args;
+      auto& buff_args = snapshot_entry( buff_list, n++, b );
+      buff_args.clear();
       buff_args.push_back( b->check() );
       if ( p->sim->json_full_states )
       {
         buff_args.push_back( b->remains().total_seconds() );
       }
-      buff_list.push_back( std::make_pair( b, buff_args ) );
     }
   }
+  buff_list.resize( n );
 
   // Adding cooldown and debuffs snapshots if asking for json full states
   if ( p->sim->json_full_states )
   {
+    n = 0;
     for ( size_t i = 0; i < p->cooldown_list.size(); ++i )
     {
       cooldown_t* c = p->cooldown_list[ i ];
       if ( c->down() )
       {
-        std::vector<double> cooldown_args;
+        auto& cooldown_args = snapshot_entry( cooldown_list, n++, c );
+        cooldown_args.clear();
         cooldown_args.push_back( c->charges );
         cooldown_args.push_back( c->remains().total_seconds() );
-        cooldown_list.push_back( std::make_pair( c, cooldown_args ) );
       }
     }
+    cooldown_list.resize( n );
+
+    n = 0;
     for ( player_t* current_target : p->sim->target_list )
     {
-      std::vector<std::pair<buff_t*, std::vector<double> > > debuff_list;
+      auto& debuff_list = snapshot_entry( target_list, n++, current_target );
+      size_t m = 0;
       for ( size_t i = 0; i < current_target->buff_list.size(); ++i )
       {
         buff_t* d = current_target->buff_list[ i ];
         if ( d->check() && !d->quiet && !d->constant )
         {
-          std::vector<double> debuff_args;
+          auto& debuff_args = snapshot_entry( debuff_list, m++, d );
+          debuff_args.clear();
           debuff_args.push_back( d->check() );
           debuff_args.push_back( d->remains().total_seconds() );
-          debuff_list.push_back( std::make_pair( d, debuff_args ) );
         }
       }
-      target_list.push_back( std::make_pair( current_target, debuff_list ) );
+      debuff_list.resize( m );
     }
+    target_list.resize( n );
   }
 
   range::fill( resource_snapshot, -1 );
@@ -11525,71 +11785,38 @@ player_collected_data_t::action_sequence_data_t::action_sequence_data_t( const a
   }
 }
 
-player_collected_data_t::action_sequence_data_t::action_sequence_data_t( const timespan_t& ts, const timespan_t& wait,
-                                                                         const player_t* p ) :
-  action( 0 ),
-  target( 0 ),
-  time( ts ),
-  wait_time( wait )
+// Move the recorded sequences into the pool of reusable entries, before recording a new iteration
+void player_collected_data_t::sequence_restart()
 {
-  for ( size_t i = 0; i < p->buff_list.size(); ++i )
+  for ( auto sequence : { &action_sequence_precombat, &action_sequence } )
   {
-    buff_t* b = p->buff_list[ i ];
-    if ( b->check() && !b->quiet && !b->constant )
-    {
-      std::vector<double> buff_args;
-      buff_args.push_back( b->check() );
-      if ( p->sim->json_full_states )
-      {
-        buff_args.push_back( b->remains().total_seconds() );
-      }
-      buff_list.push_back( std::make_pair( b, buff_args ) );
-    }
+    action_sequence_pool.insert( action_sequence_pool.end(), std::make_move_iterator( sequence->begin() ),
+                                 std::make_move_iterator( sequence->end() ) );
+    sequence->clear();
   }
+}
 
-  // Adding cooldown and debuffs snapshots if asking for json full states
-  if ( p->sim->json_full_states )
+// Append a snapshot to sequence, reusing a pooled entry if there is one
+void player_collected_data_t::sequence_append( std::vector<action_sequence_data_t>& sequence, const action_t* a,
+                                               const player_t* t, const timespan_t& ts, const timespan_t& wait,
+                                               const player_t* p )
+{
+  if ( action_sequence_pool.empty() )
   {
-    for ( size_t i = 0; i < p->cooldown_list.size(); ++i )
+    if ( a )
     {
-      cooldown_t* c = p->cooldown_list[ i ];
-      if ( c->down() )
-      {
-        std::vector<double> cooldown_args;
-        cooldown_args.push_back( c->charges );
-        cooldown_args.push_back( c->remains().total_seconds() );
-        cooldown_list.push_back( std::make_pair( c, cooldown_args ) );
-      }
+      sequence.emplace_back( a, t, ts, p );
     }
-    for ( player_t* current_target : p->sim->target_list )
+    else
     {
-      std::vector<std::pair<buff_t*, std::vector<double> > > debuff_list;
-      for ( size_t i = 0; i < current_target->buff_list.size(); ++i )
-      {
-        buff_t* d = current_target->buff_list[ i ];
-        if ( d->check() && !d->quiet && !d->constant )
-        {
-          std::vector<double> debuff_args;
-          debuff_args.push_back( d->check() );
-          debuff_args.push_back( d->remains().total_seconds() );
-          debuff_list.push_back( std::make_pair( d, debuff_args ) );
-        }
-      }
-      target_list.push_back( std::make_pair( current_target, debuff_list ) );
+      sequence.emplace_back( ts, wait, p );
     }
+    return;
   }
 
-  range::fill( resource_snapshot, -1 );
-  range::fill( resource_max_snapshot, -1 );
-
-  for ( resource_e i = RESOURCE_HEALTH; i < RESOURCE_MAX; ++i )
-  {
-    if ( p->resources.max[ i ] > 0.0 )
-    {
-      resource_snapshot[ i ]     = p->resources.current[ i ];
-      resource_max_snapshot[ i ] = p->resources.max[ i ];
-    }
-  }
+  sequence.push_back( std::move( action_sequence_pool.back() ) );
+  action_sequence_pool.pop_back();
+  sequence.back().snapshot( a, t, ts, wait, p );
 }
 
 namespace
@@ -11670,8 +11897,17 @@ player_collected_data_t::player_collected_data_t( const player_t* player ) :
 
 void player_collected_data_t::reserve_memory( const player_t& p )
 {
+  if ( p.sim->statistics_sketch > 0 )
+  {
+    enable_sketches( p );
+  }
+
   unsigned size = std::min( as<unsigned>( p.sim->iterations ), 2048u );
   fight_length.reserve( size );
+  if ( p.sim->deterministic )
+  {
+    iteration_stream.reserve( size );
+  }
   // DMG
   dmg.reserve( size );
   compound_dmg.reserve( size );
@@ -11694,6 +11930,39 @@ void player_collected_data_t::reserve_memory( const player_t& p )
     effective_theck_meloree_index.reserve( size );
     p.sim->num_tanks++;
   }
+
+  // Child threads add their samples to the main thread actor, which is initialized before any
+  // child finds it
+  if ( p.sim->target_error > 0 && p.sim->thread_index == 0 )
+  {
+    target_metric_threads = std::vector<concurrent_running_sample_data_t>( std::max( 1, p.sim->threads ) );
+  }
+}
+
+// Collect data into quantile sketches instead of storing every sample. Fight length keeps its
+// samples for timeline adjustment, as do the per-iteration metrics when paired (deterministic)
+// comparisons or the scale factor regression read them.
+void player_collected_data_t::enable_sketches( const player_t& p )
+{
+  double compression = p.sim->statistics_sketch;
+
+  for ( auto sd : { &waiting_time, &pooling_time, &executed_foreground_actions, &dmg, &compound_dmg, &heal,
+                    &compound_heal, &heal_taken, &absorb, &compound_absorb, &atps, &absorb_taken,
+                    &max_spike_amount, &target_metric } )
+  {
+    sd->enable_sketch( compression );
+  }
+
+  if ( p.sim->deterministic || !p.sim->scaling->regression_stats.empty() )
+  {
+    return;
+  }
+
+  for ( auto sd : { &prioritydps, &dps, &dpse, &dtps, &dmg_taken, &hps, &hpse, &htps, &aps, &deaths,
+                    &theck_meloree_index, &effective_theck_meloree_index } )
+  {
+    sd->enable_sketch( compression );
+  }
 }
 
 void player_collected_data_t::merge( const player_t& other_player )
@@ -11708,6 +11977,9 @@ void player_collected_data_t::merge( const player_t& other_player )
 
   total_iterations += other.total_iterations;
 
+  iteration_stream.insert( iteration_stream.end(), other.iteration_stream.begin(), other.iteration_stream.end() );
+  scale_offsets.insert( scale_offsets.end(), other.scale_offsets.begin(), other.scale_offsets.end() );
+
   fight_length.merge( other.fight_length );
   waiting_time.merge( other.waiting_time );
   executed_foreground_actions.merge( other.executed_foreground_actions );
@@ -11934,6 +12206,17 @@ void player_collected_data_t::collect_data( const player_t& p )
   waiting_time.add( w_time );
   pooling_time.add( p_time );
 
+  if ( p.sim->deterministic )
+  {
+    iteration_stream.push_back( p.sim->iteration_stream );
+  }
+
+  if ( p.scaling )
+  {
+    const auto& offsets = p.scaling->iteration_offsets;
+    scale_offsets.insert( scale_offsets.end(), offsets.begin(), offsets.end() );
+  }
+
   executed_foreground_actions.add( p.iteration_executed_foreground_actions );
 
   // Player only dmg/heal
@@ -12001,8 +12284,6 @@ void player_collected_data_t::collect_data( const player_t& p )
     double tmi       = 0;  // TMI result
     double etmi      = 0;  // ETMI result
     double max_spike = 0;  // Maximum spike size
-    health_changes.merged_timeline.merge( health_changes.timeline );
-    health_changes_tmi.merged_timeline.merge( health_changes_tmi.timeline );
 
     // Calculate Theck-Meloree Index (TMI), ETMI, and maximum spike damage
     if ( !p.is_enemy() )  // Boss TMI is irrelevant, causes problems in iteration #1
@@ -12072,11 +12353,29 @@ void player_collected_data_t::collect_data( const player_t& p )
 
     player_collected_data_t& cd = p.parent ? p.parent->collected_data : *this;
 
+    auto thread = as<size_t>( p.sim->thread_index );
+    if ( thread < cd.target_metric_threads.size() )
+    {
+      cd.target_metric_threads[ thread ].add( metric );
+    }
+
     AUTO_LOCK( cd.target_metric_mutex );
     cd.target_metric.add( metric );
   }
 }
 
+/// Running target metric statistics over all threads, safe to call while the threads are running
+running_sample_data_t player_collected_data_t::target_metric_running() const
+{
+  running_sample_data_t data;
+  for ( const auto& thread_data : target_metric_threads )
+  {
+    data.merge( thread_data.snapshot() );
+  }
+
+  return data;
+}
+
 std::ostream& player_collected_data_t::data_str( std::ostream& s ) const
 {
   fight_length.data_str( s );
@@ -2099,14 +2099,18 @@ void print_html_player_action_priority_list( report::sc_html_stream& os,
           "<tr>\n"
           "<th class=\"right\"></th>\n"
           "<th class=\"right\"></th>\n"
+          "%s"
           "<th class=\"left\">%s</th>\n"
           "</tr>\n"
           "<tr>\n"
           "<th class=\"right\">#</th>\n"
           "<th class=\"right\">count</th>\n"
+          "%s"
           "<th class=\"left\">action,conditions</th>\n"
           "</tr>\n",
-          als.c_str() );
+          sim.cache_expressions ? "<th class=\"right\"></th>\n" : "",
+          als.c_str(),
+          sim.cache_expressions ? "<th class=\"right\">cache hit</th>\n" : "" );
     }
 
     if ( !alist->used )
@@ -2124,9 +2128,20 @@ void print_html_player_action_priority_list( report::sc_html_stream& os,
             util::encode_html( a->signature->comment_.c_str() ) +
             "</em></small>";
 
+    std::string cache_str;
+    if ( sim.cache_expressions )
+    {
+      uint_least64_t checks = a->if_cache_hits + a->if_cache_misses;
+      cache_str = "<td class=\"right\" style=\"vertical-align:top\">";
+      if ( checks > 0 )
+        cache_str += util::to_string( 100.0 * a->if_cache_hits / checks, 1 ) + "%";
+      cache_str += "</td>\n";
+    }
+
     os.printf(
         "<td class=\"right\" style=\"vertical-align:top\">%c</td>\n"
         "<td class=\"left\" style=\"vertical-align:top\">%.2f</td>\n"
+        "%s"
         "<td class=\"left\">%s</td>\n"
         "</tr>\n",
         a->marker ? a->marker : ' ',
@@ -2134,6 +2149,7 @@ void print_html_player_action_priority_list( report::sc_html_stream& os,
           (double)( sim.single_actor_batch ?
             a -> player -> collected_data.total_iterations + sim.threads :
             sim.iterations ),
+        cache_str.c_str(),
         as.c_str() );
   }
 
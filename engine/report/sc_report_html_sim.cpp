@@ -455,6 +455,13 @@ void print_html_sim_summary( report::sc_html_stream& os, sim_t& sim )
       "</tr>\n",
       (long)sim.event_mgr.max_events_remaining );
 
+  os.printf(
+      "<tr class=\"left\">\n"
+      "<th>Event Queue:</th>\n"
+      "<td>%s</td>\n"
+      "</tr>\n",
+      sim.event_mgr.queue_type_str() );
+
   os.printf(
       "<tr class=\"left\">\n"
       "<th>Sim Seconds:</th>\n"
@@ -1301,6 +1308,60 @@ void print_html_overrides( report::sc_html_stream& os, const sim_t& sim )
   os << "</div>\n";
 }
 
+void print_html_event_profile( report::sc_html_stream& os, const sim_t& sim )
+{
+  const event_profile_t* profile = sim.event_mgr.profile.get();
+  if ( !profile )
+  {
+    return;
+  }
+
+  // Only the most expensive entries of each category
+  const size_t max_entries = 50;
+
+  os << "<div class=\"section\">\n";
+  os << "<h2 class=\"toggle\">Event Profile</h2>\n";
+  os << "<div class=\"toggle-content hide\">\n";
+  for ( size_t i = 0; i < event_profile_t::PROFILE_MAX; ++i )
+  {
+    auto c       = static_cast<event_profile_t::category_e>( i );
+    auto entries = profile->entries( c );
+    if ( entries.empty() )
+    {
+      continue;
+    }
+
+    double total = static_cast<double>( profile->total_nanoseconds( c ) );
+    os << "<h3>" << event_profile_t::category_string( c ) << "</h3>\n";
+    os << "<table class=\"sc\">\n";
+    os << "<tr>\n";
+    os << "<th class=\"left\">Name</th>\n";
+    os << "<th>Count</th>\n";
+    os << "<th>Seconds</th>\n";
+    os << "<th>ns/call</th>\n";
+    os << "<th>%</th>\n";
+    os << "</tr>\n";
+    for ( size_t j = 0; j < entries.size() && j < max_entries; ++j )
+    {
+      const auto& e = entries[ j ];
+      os.printf(
+          "<tr>\n"
+          "<td class=\"left\">%s</td>\n"
+          "<td class=\"right\">%llu</td>\n"
+          "<td class=\"right\">%.3f</td>\n"
+          "<td class=\"right\">%.0f</td>\n"
+          "<td class=\"right\">%.2f%%</td>\n"
+          "</tr>\n",
+          util::encode_html( e.name ).c_str(), static_cast<unsigned long long>( e.count ), e.nanoseconds / 1e9,
+          e.count ? static_cast<double>( e.nanoseconds ) / e.count : 0.0,
+          total > 0 ? 100.0 * e.nanoseconds / total : 0.0 );
+    }
+    os << "</table>\n";
+  }
+  os << "</div>\n";
+  os << "</div>\n";
+}
+
 void print_html_image_load_scripts( report::sc_html_stream& os )
 {
   print_text_array( os, __image_load_script );
@@ -1411,6 +1472,7 @@ void print_html_( report::sc_html_stream& os, sim_t& sim )
   sim.profilesets.output_html( sim, os );
 
   print_html_sim_summary( os, sim );
+  print_html_event_profile( os, sim );
 
   if ( sim.report_raw_abilities )
     raw_ability_summary::print( os, sim );
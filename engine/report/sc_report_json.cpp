@@ -776,15 +776,21 @@ void to_json( JsonOutput& arr, const raid_event_t& event )
   add_non_zero( root, "saved_duration", event.saved_duration );
 }
 
-void iteration_data_to_json( JsonOutput root, const std::vector<iteration_data_entry_t>& entries )
+void iteration_data_to_json( JsonOutput root, const std::vector<iteration_data_entry_t>& entries, uint64_t stream_key )
 {
   root.make_array();
 
-  range::for_each( entries, [ &root ]( const iteration_data_entry_t& entry ) {
+  range::for_each( entries, [ &root, stream_key ]( const iteration_data_entry_t& entry ) {
     auto json_entry = root.add();
 
     json_entry[ "metric" ] = entry.metric;
     json_entry[ "seed" ] = entry.seed;
+    // Replaying the iteration needs seed=<stream_key> replay_iteration=<iteration>
+    if ( stream_key )
+    {
+      json_entry[ "stream_key" ] = stream_key;
+    }
+    json_entry[ "iteration" ] = entry.iteration;
     json_entry[ "target_health" ] = entry.target_health;
   } );
 }
@@ -802,6 +808,10 @@ void to_json( JsonOutput root, const sim_t& sim )
   options_root[ "target_error" ] = sim.target_error;
   options_root[ "threads" ] = sim.threads;
   options_root[ "seed" ] = sim.seed;
+  if ( sim.deterministic )
+  {
+    options_root[ "stream_key" ] = sim.stream_key;
+  }
   options_root[ "single_actor_batch" ] = sim.single_actor_batch;
   options_root[ "queue_lag" ] = sim.queue_lag;
   options_root[ "queue_lag_stddev" ] = sim.queue_lag_stddev;
@@ -896,10 +906,56 @@ void to_json( JsonOutput root, const sim_t& sim )
   stats_root[ "elapsed_cpu_seconds" ] = sim.elapsed_cpu;
   stats_root[ "elapsed_time_seconds" ] = sim.elapsed_time;
   stats_root[ "init_time_seconds" ] = sim.init_time;
+  if ( sim.init_time_per_thread.size() > 1 )
+  {
+    stats_root[ "init_time_per_thread_seconds" ] = sim.init_time_per_thread;
+  }
   stats_root[ "merge_time_seconds" ] = sim.merge_time;
   stats_root[ "analyze_time_seconds" ] = sim.analyze_time;
   stats_root[ "simulation_length" ] = sim.simulation_length;
   stats_root[ "total_events_processed" ] = sim.event_mgr.total_events_processed;
+
+  auto event_alloc_arr = stats_root[ "event_allocations" ].make_array();
+  for ( unsigned i = 0; i < event_manager_t::EVENT_SIZE_CLASSES; ++i )
+  {
+    if ( sim.event_mgr.n_class_requests[ i ] == 0 )
+    {
+      continue;
+    }
+
+    auto node = event_alloc_arr.add();
+    node[ "block_size" ] = static_cast<unsigned>( event_manager_t::event_block_size( i ) );
+    node[ "allocations" ] = sim.event_mgr.n_class_requests[ i ];
+    node[ "slabs" ] = sim.event_mgr.n_class_slabs[ i ];
+  }
+
+  if ( const event_profile_t* profile = sim.event_mgr.profile.get() )
+  {
+    auto profile_root = stats_root[ "event_profile" ];
+    for ( size_t i = 0; i < event_profile_t::PROFILE_MAX; ++i )
+    {
+      auto c = static_cast<event_profile_t::category_e>( i );
+      auto entries_arr = profile_root[ util::tokenize_fn( event_profile_t::category_string( c ) ) ].make_array();
+      for ( const auto& entry : profile -> entries( c ) )
+      {
+        auto node = entries_arr.add();
+        node[ "name" ] = entry.name;
+        node[ "count" ] = entry.count;
+        node[ "nanoseconds" ] = entry.nanoseconds;
+      }
+    }
+  }
+  auto memory_root = stats_root[ "memory" ];
+  for ( size_t i = 0; i < memory_usage_t::MEMORY_MAX; ++i )
+  {
+    auto c = static_cast<memory_usage_t::category_e>( i );
+    auto node = memory_root[ util::tokenize_fn( memory_usage_t::category_string( c ) ) ];
+    node[ "final" ] = static_cast<uint64_t>( sim.memory.current[ i ] );
+    node[ "peak" ] = static_cast<uint64_t>( sim.memory.peak[ i ] );
+  }
+  memory_root[ "total" ][ "final" ] = static_cast<uint64_t>( sim.memory.total() );
+  memory_root[ "total" ][ "peak" ] = static_cast<uint64_t>( sim.memory.peak_total );
+
   add_non_zero( stats_root, "raid_dps", sim.raid_dps );
   add_non_zero( stats_root, "raid_hps", sim.raid_hps );
   add_non_zero( stats_root, "raid_aps", sim.raid_aps );
@@ -940,19 +996,20 @@ void to_json( JsonOutput root, const sim_t& sim )
 
     if ( sim.low_iteration_data.size() > 0 )
     {
-      iteration_data_to_json( root[ "iteration_data" ][ "low" ], sim.low_iteration_data );
+      iteration_data_to_json( root[ "iteration_data" ][ "low" ], sim.low_iteration_data,
+                              sim.deterministic && ! sim.strict_work_queue ? sim.stream_key : 0 );
     }
 
     if ( sim.high_iteration_data.size() > 0 )
     {
-      iteration_data_to_json( root[ "iteration_data" ][ "high" ], sim.high_iteration_data );
+      iteration_data_to_json( root[ "iteration_data" ][ "high" ], sim.high_iteration_data,
+                              sim.deterministic && ! sim.strict_work_queue ? sim.stream_key : 0 );
     }
   }
 }
 
-void print_json_pretty( FILE* o, const sim_t& sim )
+void build_json_report( Document& doc, const sim_t& sim )
 {
-  Document doc;
   Value& v = doc;
   v.SetObject();
 
@@ -975,6 +1032,12 @@ void print_json_pretty( FILE* o, const sim_t& sim )
   {
     root[ "notifications" ] = sim.error_list;
   }
+}
+
+void print_json_pretty( FILE* o, const sim_t& sim )
+{
+  Document doc;
+  build_json_report( doc, sim );
 
   std::array<char, 16384> buffer;
   FileWriteStream b( o, buffer.data(), buffer.size() );
@@ -990,6 +1053,22 @@ void print_json_pretty( FILE* o, const sim_t& sim )
 
 namespace report
 {
+// Compact, single line JSON report of the sim
+std::string json_report_str( const sim_t& sim )
+{
+  Document doc;
+  build_json_report( doc, sim );
+
+  StringBuffer b;
+  Writer<StringBuffer> writer( b );
+  if ( !doc.Accept( writer ) )
+  {
+    throw std::runtime_error("JSON Writer did not accept document.");
+  }
+
+  return std::string( b.GetString(), b.GetSize() );
+}
+
 void print_json( sim_t& sim )
 {
   if ( ! sim.json_file_str.empty() )
@@ -631,6 +631,11 @@ void print_iteration_data( std::ostream& os, const sim_t& sim )
   }
 
   fmt::print( os, "\nIteration data:\n" );
+  if ( sim.deterministic && ! sim.strict_work_queue )
+  {
+    fmt::print( os, "Stream key: {} (replay an iteration with seed={} replay_iteration=<Iter#>)\n",
+                sim.stream_key, sim.stream_key );
+  }
   if ( sim.low_iteration_data.size() && sim.high_iteration_data.size() )
   {
     fmt::print(
@@ -770,13 +775,30 @@ void sim_summary_performance( std::ostream& os, sim_t* sim )
     iterations_str << ")";
   }
 
+  std::string init_str;
+  if ( sim -> threads > 1 && ! sim -> init_time_per_thread.empty() )
+  {
+    init_str = fmt::format( " ({:.3f})", fmt::join( sim -> init_time_per_thread, ", " ) );
+  }
+
+  std::string stealing_str;
+  if ( ! sim -> steals_per_thread.empty() )
+  {
+    stealing_str = fmt::format( "  Steals        = ({})\n"
+                                "  IdleSeconds   = ({:.3f})\n",
+        fmt::join( sim -> steals_per_thread, ", " ),
+        fmt::join( sim -> idle_per_thread, ", " ) );
+  }
+
   fmt::print(
       os,
       "\n\nBaseline Performance:\n"
       "  RNG Engine    = {}{}\n"
       "  Iterations    = {}{}\n"
+      "{}"
       "  TotalEvents   = {:n}\n"
       "  MaxEventQueue = {}\n"
+      "  EventQueue    = {}\n"
 #ifdef EVENT_QUEUE_DEBUG
       "  AllocEvents   = {}\n"
       "  EndInsert     = {} ({:.3f}%)\n"
@@ -787,7 +809,7 @@ void sim_summary_performance( std::ostream& os, sim_t* sim )
       "  SimSeconds    = {}\n"
       "  CpuSeconds    = {}\n"
       "  WallSeconds   = {}\n"
-      "  InitSeconds   = {}\n"
+      "  InitSeconds   = {}{}\n"
       "  MergeSeconds  = {}\n"
       "  AnalyzeSeconds= {}\n"
       "  SpeedUp       = {}\n"
@@ -795,8 +817,10 @@ void sim_summary_performance( std::ostream& os, sim_t* sim )
       sim->rng().name(), sim->deterministic ? " (deterministic)" : "",
       sim->iterations,
       sim -> threads > 1 ? iterations_str.str().c_str() : "",
+      stealing_str,
       sim->event_mgr.total_events_processed,
       sim->event_mgr.max_events_remaining,
+      sim->event_mgr.queue_type_str(),
 #ifdef EVENT_QUEUE_DEBUG
       sim->event_mgr.n_allocated_events, sim->event_mgr.n_end_insert,
       100.0 * static_cast<double>( sim->event_mgr.n_end_insert ) /
@@ -808,7 +832,7 @@ void sim_summary_performance( std::ostream& os, sim_t* sim )
       sim->target->resources.base[ RESOURCE_HEALTH ],
       sim->simulation_length.sum(), sim->elapsed_cpu,
       sim->elapsed_time,
-      sim->init_time,
+      sim->init_time, init_str,
       sim->merge_time,
       sim->analyze_time,
       sim->iterations * sim->simulation_length.mean() / sim->elapsed_cpu,
@@ -861,9 +885,21 @@ void sim_summary_performance( std::ostream& os, sim_t* sim )
   fmt::print( os, "Total: {:.3f}% Alloc Samples: {}\n",
       total_p,
       sim->event_mgr.n_requested_events );
-  fmt::print( os, "Alloc size used for event_t: {}\n",
-      util::next_power_of_two( 2 * sizeof( event_t ) ) );
 #endif
+
+  fmt::print( os, "Event Allocator:\n" );
+  for ( unsigned i = 0; i < event_manager_t::EVENT_SIZE_CLASSES; ++i )
+  {
+    if ( sim->event_mgr.n_class_requests[ i ] == 0 )
+    {
+      continue;
+    }
+
+    fmt::print( os, "  Block {:5} = {} allocations, {} slabs\n",
+        event_manager_t::event_block_size( i ),
+        sim->event_mgr.n_class_requests[ i ],
+        sim->event_mgr.n_class_slabs[ i ] );
+  }
 }
 
 void print_raid_scale_factors( std::ostream& os, sim_t* sim )
@@ -1126,6 +1162,87 @@ void event_manager_infos( std::ostream& os, const sim_t& sim )
 #endif  // ACTOR_EVENT_BOOKKEEPING
 }
 
+void event_profile_infos( std::ostream& os, const sim_t& sim )
+{
+  const event_profile_t* profile = sim.event_mgr.profile.get();
+  if ( !profile )
+    return;
+
+  // Only the most expensive entries of each category
+  const size_t max_entries = 20;
+
+  fmt::print( os, "\nEvent Profile:\n" );
+  for ( size_t i = 0; i < event_profile_t::PROFILE_MAX; ++i )
+  {
+    auto c       = static_cast<event_profile_t::category_e>( i );
+    auto entries = profile->entries( c );
+    if ( entries.empty() )
+      continue;
+
+    double total = static_cast<double>( profile->total_nanoseconds( c ) );
+    fmt::print( os, "  {} ({:.3f}sec):\n", event_profile_t::category_string( c ), total / 1e9 );
+    fmt::print( os, "    {:<48} {:>12} {:>10} {:>10} {:>7}\n", "name", "count", "sec", "ns/call", "%" );
+    for ( size_t j = 0; j < entries.size() && j < max_entries; ++j )
+    {
+      const auto& e = entries[ j ];
+      fmt::print( os, "    {:<48} {:>12} {:>10.3f} {:>10.0f} {:>6.2f}%\n", e.name, e.count, e.nanoseconds / 1e9,
+                  e.count ? static_cast<double>( e.nanoseconds ) / e.count : 0.0,
+                  total > 0 ? 100.0 * e.nanoseconds / total : 0.0 );
+    }
+  }
+}
+
+void memory_usage_infos( std::ostream& os, const sim_t& sim )
+{
+  const memory_usage_t& memory = sim.memory;
+  if ( memory.peak_total == 0 )
+    return;
+
+  const double mib = 1024.0 * 1024.0;
+
+  fmt::print( os, "\nMemory Usage:\n" );
+  fmt::print( os, "  {:<20} {:>12} {:>12}\n", "category", "final MiB", "peak MiB" );
+  for ( size_t i = 0; i < memory_usage_t::MEMORY_MAX; ++i )
+  {
+    fmt::print( os, "  {:<20} {:>12.2f} {:>12.2f}\n",
+                memory_usage_t::category_string( static_cast<memory_usage_t::category_e>( i ) ),
+                memory.current[ i ] / mib, memory.peak[ i ] / mib );
+  }
+  fmt::print( os, "  {:<20} {:>12.2f} {:>12.2f}\n", "Total", memory.total() / mib, memory.peak_total / mib );
+}
+
+void stat_cache_infos( std::ostream& os, const sim_t& sim )
+{
+  if ( !sim.monitor_stat_cache )
+    return;
+
+  fmt::print( os, "\nStat Cache Report:\n" );
+  for ( const auto& p : sim.actor_list )
+  {
+    const player_stat_cache_t& cache = p->cache;
+    uint64_t total = 0;
+    for ( size_t i = 0; i < CACHE_MAX; ++i )
+      total += cache.hits[ i ] + cache.recomputes[ i ] + cache.invalidations[ i ];
+    if ( total == 0 )
+      continue;
+
+    fmt::print( os, "  {}:\n", p->name() );
+    fmt::print( os, "    {:<24} {:>12} {:>12} {:>12} {:>7}\n", "cache", "hits", "recomputes",
+                "invalidated", "hit%" );
+    for ( size_t i = 0; i < CACHE_MAX; ++i )
+    {
+      uint64_t accesses = cache.hits[ i ] + cache.recomputes[ i ];
+      if ( accesses + cache.invalidations[ i ] == 0 )
+        continue;
+
+      fmt::print( os, "    {:<24} {:>12} {:>12} {:>12} {:>6.2f}%\n",
+                  util::cache_type_string( static_cast<cache_e>( i ) ), cache.hits[ i ],
+                  cache.recomputes[ i ], cache.invalidations[ i ],
+                  accesses ? 100.0 * cache.hits[ i ] / accesses : 0.0 );
+    }
+  }
+}
+
 void print_collected_amount( std::ostream& os, const player_t& p, std::string name, const extended_sample_data_t& sd )
 {
   if ( sd.sum() <= 0.0 )
@@ -1302,6 +1419,9 @@ void print_text_report( std::ostream& os, sim_t* sim, bool detail )
     print_raid_scale_factors( os, sim );
     print_reference_dps( os, *sim );
     event_manager_infos( os, *sim );
+    event_profile_infos( os, *sim );
+    memory_usage_infos( os, *sim );
+    stat_cache_infos( os, *sim );
   }
 
   fmt::print( os, "\n" );
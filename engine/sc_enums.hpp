@@ -1245,3 +1245,12 @@ enum haste_type_e
   HASTE_ANY, // Special value to indicate any (all) haste types
   SPEED_ANY,
 };
+
+// Event queue implementation used by the event manager
+enum event_queue_e
+{
+  EVENT_QUEUE_WHEEL = 0,  // Timing wheel with sorted per-slice event lists
+  EVENT_QUEUE_LADDER,     // Timing wheel with unsorted slices, sorted lazily when reached
+  EVENT_QUEUE_RADIX_HEAP, // Monotone radix heap keyed on ( time, id )
+  EVENT_QUEUE_MAX
+};
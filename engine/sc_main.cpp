@@ -6,8 +6,15 @@
 #include "simulationcraft.hpp"
 #include "util/git_info.hpp"
 #include "sim/sc_profileset.hpp"
+#include "util/rapidjson/document.h"
 #include <locale>
 
+#ifdef SC_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 // ==========================================================================
 // Compiler Minimal Limit Deprecation Warning
 // Added here so that we only get 1 warning / build process
@@ -222,33 +229,306 @@ struct special_effect_initializer_t
   { unique_gear::unregister_special_effects(); }
 };
 
-} // anonymous namespace ====================================================
-
-// sim_t::main ==============================================================
-
-int sim_t::main( const std::vector<std::string>& args )
+struct module_initializer_t
 {
-  try
+  module_initializer_t()
   {
-    cache_initializer_t cache_init( get_cache_directory() + "/simc_cache.dat" );
-    dbc_initializer_t dbc_init;
     module_t::init();
     unique_gear::register_hotfixes();
+  }
+};
 
-    special_effect_initializer_t special_effect_init;
+// Process wide data shared by all sims of the process
+struct engine_initializer_t
+{
+  cache_initializer_t cache_init;
+  dbc_initializer_t dbc_init;
+  module_initializer_t module_init;
+  special_effect_initializer_t special_effect_init;
+
+  engine_initializer_t() :
+    cache_init( get_cache_directory() + "/simc_cache.dat" )
+  { }
+};
 
-    // Print simc version info
-    if ( !git_info::available() )
-    {
+void print_version( const dbc_t& dbc )
+{
+  if ( !git_info::available() )
+  {
     util::printf("SimulationCraft %s for World of Warcraft %s %s (wow build %s)\n",
         SC_VERSION, dbc.wow_version(), dbc.wow_ptr_status(), util::to_string(dbc.build_level()).c_str());
-    }
-    else
-    {
+  }
+  else
+  {
     util::printf("SimulationCraft %s for World of Warcraft %s %s (wow build %s, git build %s %s)\n",
         SC_VERSION, dbc.wow_version(), dbc.wow_ptr_status(), util::to_string(dbc.build_level()).c_str(), git_info::branch(), git_info::revision());
+  }
+  std::cout << std::endl;
+}
+
+// Runs the simulation, the scaling, plot, reforge plot and profileset analyses, and prints the
+// reports. Returns false if the simulation itself was canceled, the cancel state of the rest is
+// in sim.canceled.
+bool execute_and_report( sim_t& sim )
+{
+  sim.progress_bar.set_base( "Baseline" );
+  if ( ! sim.execute() )
+  {
+    sim.canceled = 1;
+    return false;
+  }
+
+  sim.scaling      -> analyze();
+  sim.plot         -> analyze();
+  sim.reforge_plot -> analyze();
+
+  if ( sim.canceled == 0 && ! sim.profilesets.iterate( &sim ) )
+  {
+    sim.canceled = 1;
+  }
+  else
+  {
+    report::print_suite( &sim );
+  }
+
+  return true;
+}
+
+// Job server ===============================================================
+
+/* Runs sim jobs read from standard input in one long running process ( simc serve=1 [options] ),
+ * so jobs do not pay for process startup, dbc, module and special effect initialization. Every
+ * job runs on a fresh sim_t, with the options given on the command line followed by the options
+ * of the job. Jobs run one at a time, in the order they are received. Spell data overrides
+ * ( override.spell_data ) are dropped at the end of every job.
+ *
+ * Jobs are either option text, terminated by a line "run" or "run <id>", or a single line JSON
+ * object { "id": <id>, "options": <option text, or array of options> }. Jobs without an id are
+ * numbered. The line "quit", or the end of input, stops the server.
+ *
+ * Standard output only carries the replies of the server, one line each, fields separated by
+ * tabs. Everything else the sims print is redirected to standard error.
+ *   ready                      the server accepts jobs
+ *   accepted <id>              the job was read and starts
+ *   progress <id> <progress>   a progress bar update of the job ( see progressbar_type )
+ *   report <id> <json>         the JSON report of the finished job, on a single line
+ *   error <id> <message>       the job failed
+ *   done <id> <status>         the job ended, status is 0 on success
+ */
+class job_server_t
+{
+  std::vector<std::string> base_args;
+  FILE* out;
+  mutex_t out_mutex;
+  unsigned job_count;
+
+  void reply( const std::string& type, const std::string& id, const std::string& data = std::string() )
+  {
+    std::string line = type;
+    if ( ! id.empty() )
+    {
+      line += '\t';
+      line += id;
+    }
+    if ( ! data.empty() )
+    {
+      line += '\t';
+      line += data;
+    }
+    std::replace( line.begin(), line.end(), '\n', ' ' );
+    std::replace( line.begin(), line.end(), '\r', ' ' );
+
+    AUTO_LOCK( out_mutex );
+    fmt::print( out, "{}\n", line );
+    fflush( out );
+  }
+
+  int run_job( const std::string& id, const std::vector<std::string>& args, const std::string& text )
+  {
+    reply( "accepted", id );
+
+    int status = 1;
+    try
+    {
+      sim_t sim;
+      sim.progressbar_type = 1;
+      sim.progress_bar.output_callback = [ this, &id ]( const std::string& line ) {
+        reply( "progress", id, line );
+      };
+
+      sim_control_t control;
+      try
+      {
+        control.options.parse_args( base_args );
+        control.options.parse_args( args );
+        control.options.parse_text( text );
+      }
+      catch ( const std::exception& )
+      {
+        std::throw_with_nested( std::invalid_argument( "Incorrect option format" ) );
+      }
+
+      try
+      {
+        sim.setup( &control );
+      }
+      catch ( const std::exception& )
+      {
+        std::throw_with_nested( std::runtime_error( "Setup failure" ) );
+      }
+
+      if ( sim.spell_query || sim.display_hotfixes || sim.display_bonus_ids || need_to_save_profiles( &sim ) )
+      {
+        throw std::invalid_argument( "Only simulations can be served" );
+      }
+
+      if ( sim.canceled )
+      {
+        throw std::runtime_error( "Simulation was canceled" );
+      }
+
+      sim_signal_handler_t::global_sim = &sim;
+      execute_and_report( sim );
+      sim_signal_handler_t::global_sim = nullptr;
+
+      if ( sim.canceled )
+      {
+        reply( "error", id, "Simulation was canceled" );
+      }
+      else
+      {
+        reply( "report", id, report::json_report_str( sim ) );
+        status = 0;
+      }
+    }
+    catch ( const std::exception& e )
+    {
+      sim_signal_handler_t::global_sim = nullptr;
+      std::ostringstream s;
+      util::print_chained_exception( e, s );
+      reply( "error", id, s.str() );
+    }
+
+    // Spell data overrides ( override.spell_data ) are process wide, drop them so they do not leak
+    // into the next job
+    dbc_override::clear();
+
+    reply( "done", id, util::to_string( status ) );
+    return status;
+  }
+
+  // Run a single line JSON job
+  void run_json_job( const std::string& line )
+  {
+    std::string id = util::to_string( ++job_count );
+    rapidjson::Document job;
+    job.Parse( line.c_str() );
+    if ( job.HasParseError() || ! job.IsObject() )
+    {
+      reply( "error", id, "Invalid JSON job" );
+      reply( "done", id, "1" );
+      return;
     }
-    std::cout << std::endl;
+
+    if ( job.HasMember( "id" ) && job[ "id" ].IsString() )
+    {
+      id = job[ "id" ].GetString();
+    }
+    else if ( job.HasMember( "id" ) && job[ "id" ].IsUint() )
+    {
+      id = util::to_string( job[ "id" ].GetUint() );
+    }
+
+    std::vector<std::string> args;
+    std::string text;
+    if ( job.HasMember( "options" ) && job[ "options" ].IsString() )
+    {
+      text = job[ "options" ].GetString();
+    }
+    else if ( job.HasMember( "options" ) && job[ "options" ].IsArray() )
+    {
+      for ( const auto& option : job[ "options" ].GetArray() )
+      {
+        if ( option.IsString() )
+        {
+          args.push_back( option.GetString() );
+        }
+      }
+    }
+
+    run_job( id, args, text );
+  }
+
+public:
+  job_server_t( std::vector<std::string> args ) :
+    base_args( std::move( args ) ), out( stdout ), job_count( 0 )
+  {
+    // Keep the original standard output for replies, and send all other output to standard error
+    fflush( stdout );
+#ifdef SC_WINDOWS
+    int fd = _dup( _fileno( stdout ) );
+    FILE* f = fd != -1 ? _fdopen( fd, "w" ) : nullptr;
+    if ( f )
+      _dup2( _fileno( stderr ), _fileno( stdout ) );
+#else
+    int fd = dup( fileno( stdout ) );
+    FILE* f = fd != -1 ? fdopen( fd, "w" ) : nullptr;
+    if ( f )
+      dup2( fileno( stderr ), fileno( stdout ) );
+#endif
+    if ( f )
+      out = f;
+  }
+
+  int serve()
+  {
+    reply( "ready", std::string() );
+
+    std::string line, text;
+    while ( std::getline( std::cin, line ) )
+    {
+      if ( ! line.empty() && line.back() == '\r' )
+      {
+        line.pop_back();
+      }
+
+      if ( line == "quit" )
+      {
+        break;
+      }
+      else if ( text.empty() && ! line.empty() && line[ 0 ] == '{' )
+      {
+        run_json_job( line );
+      }
+      else if ( line == "run" || util::str_prefix_ci( line, "run " ) )
+      {
+        std::string id = line.size() > 4 ? line.substr( 4 ) : util::to_string( ++job_count );
+        run_job( id, std::vector<std::string>(), text );
+        text.clear();
+      }
+      else
+      {
+        text += line;
+        text += '\n';
+      }
+    }
+
+    return 0;
+  }
+};
+
+} // anonymous namespace ====================================================
+
+// sim_t::main ==============================================================
+
+int sim_t::main( const std::vector<std::string>& args )
+{
+  try
+  {
+    engine_initializer_t engine_init;
+
+    // Print simc version info
+    print_version( dbc );
 
     sim_control_t control;
 
@@ -319,26 +599,9 @@ int sim_t::main( const std::vector<std::string>& args )
       util::printf( "\nSimulating... ( iterations=%d, threads=%d, target_error=%.3f,  max_time=%.0f, vary_combat_length=%0.2f, optimal_raid=%d, fight_style=%s )\n\n",
         iterations, threads, target_error, max_time.total_seconds(), vary_combat_length, optimal_raid, fight_style.c_str() );
 
-      progress_bar.set_base( "Baseline" );
-      if ( execute() )
-      {
-        scaling      -> analyze();
-        plot         -> analyze();
-        reforge_plot -> analyze();
-
-        if ( canceled == 0 && ! profilesets.iterate( this ))
-        {
-          canceled = 1;
-        }
-        else
-        {
-          report::print_suite( this );
-        }
-      }
-      else
+      if ( ! execute_and_report( *this ) )
       {
         util::printf("Simulation was canceled.\n");
-        canceled = 1;
       }
     }
 
@@ -367,8 +630,27 @@ int main( int argc, char** argv )
   _set_output_format( _TWO_DIGIT_EXPONENT );
 #endif
 
+  io::utf8_args args( argc, argv );
+
+  // Serve sim jobs from standard input, command line options apply to every job
+  auto serve = std::find_if( args.begin(), args.end(), []( const std::string& arg ) {
+    return util::str_prefix_ci( arg, "serve=" );
+  } );
+  if ( serve != args.end() && *serve != "serve=0" )
+  {
+    std::vector<std::string> base_args( args.begin(), serve );
+    base_args.insert( base_args.end(), serve + 1, args.end() );
+
+    job_server_t server( std::move( base_args ) );
+    engine_initializer_t engine_init;
+    print_version( dbc_t( false ) );
+    hotfix::apply();
+
+    return server.serve();
+  }
+
   sim_t sim;
   sim_signal_handler_t::global_sim = &sim;
 
-  return sim.main( io::utf8_args( argc, argv ) );
+  return sim.main( args );
 }
@@ -1074,6 +1074,26 @@ movement_direction_e util::parse_movement_direction( const std::string& name )
   return parse_enum<movement_direction_e, MOVEMENT_UNKNOWN, MOVEMENT_DIRECTION_MAX, movement_direction_string>( name );
 }
 
+// event_queue_type_string ==================================================
+
+const char* util::event_queue_type_string( event_queue_e q )
+{
+  switch ( q )
+  {
+    case EVENT_QUEUE_WHEEL:      return "wheel";
+    case EVENT_QUEUE_LADDER:     return "ladder";
+    case EVENT_QUEUE_RADIX_HEAP: return "radix_heap";
+    default:                     return "unknown";
+  }
+}
+
+// parse_event_queue_type ===================================================
+
+event_queue_e util::parse_event_queue_type( const std::string& name )
+{
+  return parse_enum_with_default<event_queue_e, EVENT_QUEUE_WHEEL, EVENT_QUEUE_MAX, EVENT_QUEUE_MAX, event_queue_type_string>( name );
+}
+
 // cache_type_string ========================================================
 
 const char* util::cache_type_string( cache_e c )
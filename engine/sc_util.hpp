@@ -68,6 +68,7 @@ const char* weapon_subclass_string    ( int subclass );
 const char* item_quality_string       ( int quality );
 const char* specialization_string     ( specialization_e spec );
 const char* movement_direction_string( movement_direction_e );
+const char* event_queue_type_string   ( event_queue_e );
 const char* class_id_string( player_e type );
 const char* spec_string_no_class( const player_t&p );
 const char* retarget_event_string     ( retarget_event_e );
@@ -104,6 +105,7 @@ specialization_e parse_specialization_type( const std::string &name );
 movement_direction_e parse_movement_direction( const std::string& name );
 item_subclass_armor parse_armor_type( const std::string& name );
 weapon_e parse_weapon_type       ( const std::string& name );
+event_queue_e parse_event_queue_type( const std::string& name );
 
 int parse_item_quality                ( const std::string& quality );
 bool parse_origin( std::string& region, std::string& server, std::string& name, const std::string& origin );
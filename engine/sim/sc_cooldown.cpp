@@ -454,7 +454,22 @@ expr_t* cooldown_t::create_expression( const std::string& name_str )
     } );
   }
   else if ( name_str == "up" || name_str == "ready" )
-    return make_mem_fn_expr( name_str, *this, &cooldown_t::up );
+  {
+    struct up_expr_t : public expr_t
+    {
+      const cooldown_t* cd;
+      up_expr_t( const std::string& n, const cooldown_t* c ) :
+        expr_t( n ), cd( c )
+      { }
+
+      double evaluate() override
+      { return cd -> up(); }
+
+      void compile( expression::program_t& prog ) override
+      { prog.emit_load_ready( this, cd -> ready ); }
+    };
+    return new up_expr_t( name_str, this );
+  }
 
   else if ( name_str == "charges" )
   {
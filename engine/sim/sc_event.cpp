@@ -84,6 +84,144 @@ void event_t::cancel( event_t*& e )
 // Event Manager
 // ==========================================================================
 
+namespace {
+
+// Stable merge sort of a singly linked event list by event time. Events with
+// equal time retain their insertion order, which keeps the ladder queue
+// execution order identical to the timing wheel.
+event_t* sort_event_list( event_t* list )
+{
+  if ( ! list || ! list -> next )
+    return list;
+
+  event_t* slow = list;
+  event_t* fast = list -> next;
+  while ( fast && fast -> next )
+  {
+    slow = slow -> next;
+    fast = fast -> next -> next;
+  }
+
+  event_t* right = sort_event_list( slow -> next );
+  slow -> next = nullptr;
+  event_t* left = sort_event_list( list );
+
+  event_t* head = nullptr;
+  event_t** tail = &head;
+  while ( left && right )
+  {
+    if ( right -> time < left -> time )
+    {
+      *tail = right;
+      right = right -> next;
+    }
+    else
+    {
+      *tail = left;
+      left = left -> next;
+    }
+    tail = &( ( *tail ) -> next );
+  }
+  *tail = left ? left : right;
+
+  return head;
+}
+
+// Radix heap key of an event. Event ids increase monotonically within an
+// iteration, so ( time, id ) is unique and orders same-time events in
+// insertion order, exactly like the timing wheel does.
+inline uint64_t radix_key( const event_t* e )
+{
+  return ( static_cast<uint64_t>( e -> time.total_millis() ) << 32 ) | e -> id;
+}
+
+inline unsigned radix_bucket_index( uint64_t key, uint64_t last )
+{
+  uint64_t diff = key ^ last;
+  unsigned index = 0;
+  while ( diff )
+  {
+    ++index;
+    diff >>= 1;
+  }
+  return index;
+}
+
+// Number of slabs obtained from the system allocator at once. One extra slab
+// worth of memory is requested to align the slabs to EVENT_SLAB_SIZE.
+const std::size_t EVENT_SLABS_PER_ARENA = 8;
+
+} // unnamed namespace
+
+const unsigned event_manager_t::EVENT_SIZE_CLASSES;
+const std::size_t event_manager_t::EVENT_MIN_BLOCK_SIZE;
+const std::size_t event_manager_t::EVENT_SLAB_SIZE;
+
+// ==========================================================================
+// Event Slab
+// ==========================================================================
+
+/**
+ * Header of an event slab. Slabs are aligned to EVENT_SLAB_SIZE, so the slab
+ * (and size class) of any event can be found by masking its address. Blocks
+ * start on the first cache line after the header. A bitmask of live blocks
+ * lets the event manager flush outstanding events without tracking every
+ * block it has ever handed out.
+ */
+struct event_slab_t
+{
+  static const std::size_t MAX_BLOCKS = event_manager_t::EVENT_SLAB_SIZE / event_manager_t::EVENT_MIN_BLOCK_SIZE;
+  static const std::size_t HEADER_SIZE = event_manager_t::EVENT_MIN_BLOCK_SIZE;
+
+  unsigned size_class;
+  unsigned n_blocks;
+  unsigned live;
+  std::array<uint64_t, MAX_BLOCKS / 64> live_mask;
+
+  event_slab_t( unsigned c ) :
+    size_class( c ),
+    n_blocks( static_cast<unsigned>( ( event_manager_t::EVENT_SLAB_SIZE - HEADER_SIZE ) /
+                                     event_manager_t::event_block_size( c ) ) ),
+    live( 0 ),
+    live_mask()
+  { }
+
+  static event_slab_t* slab_of( const void* block )
+  {
+    return reinterpret_cast<event_slab_t*>( reinterpret_cast<uintptr_t>( block ) &
+                                            ~( event_manager_t::EVENT_SLAB_SIZE - 1 ) );
+  }
+
+  event_t* block( unsigned index )
+  {
+    return reinterpret_cast<event_t*>( reinterpret_cast<char*>( this ) + HEADER_SIZE +
+                                       index * event_manager_t::event_block_size( size_class ) );
+  }
+
+  unsigned index_of( const void* block ) const
+  {
+    return static_cast<unsigned>( ( reinterpret_cast<const char*>( block ) -
+                                    reinterpret_cast<const char*>( this ) - HEADER_SIZE ) /
+                                  event_manager_t::event_block_size( size_class ) );
+  }
+
+  void acquire( const void* block )
+  {
+    unsigned index = index_of( block );
+    live_mask[ index / 64 ] |= uint64_t( 1 ) << ( index % 64 );
+    live++;
+  }
+
+  void release( const void* block )
+  {
+    unsigned index = index_of( block );
+    live_mask[ index / 64 ] &= ~( uint64_t( 1 ) << ( index % 64 ) );
+    live--;
+  }
+};
+
+static_assert( sizeof( event_slab_t ) <= event_slab_t::HEADER_SIZE, "Event slab header does not fit in one cache line" );
+
 // event_manager_t::event_manager_t =========================================
 
 event_manager_t::event_manager_t( sim_t* s )
@@ -95,17 +233,27 @@ event_manager_t::event_manager_t( sim_t* s )
     timing_slice( 0 ),
     global_event_id( 1 ),  // start at 1, so we can identify event -> id == 0
                            // meaning a unscheduled event.
+    queue_type( EVENT_QUEUE_WHEEL ),
     timing_wheel(),
-    recycled_event_list( nullptr ),
+    timing_wheel_tail(),
+    radix_bucket(),
+    radix_last( 0 ),
     wheel_seconds( 0 ),
     wheel_size( 0 ),
     wheel_mask( 0 ),
     wheel_shift( 5 ),
     wheel_granularity( 0.0 ),
     wheel_time( timespan_t::zero() ),
+    recycled_event_list(),
+    event_slabs(),
+    spare_event_slabs(),
+    event_arenas(),
+    n_class_requests(),
+    n_class_slabs(),
     event_stopwatch( STOPWATCH_THREAD ),
 #ifdef EVENT_QUEUE_DEBUG
     monitor_cpu( false ),
+    profile_events( false ),
     max_queue_depth( 0 ),
     n_allocated_events( 0 ),
     n_requested_events( 0 ),
@@ -114,33 +262,85 @@ event_manager_t::event_manager_t( sim_t* s )
     events_added( 0 )
 #else
     monitor_cpu( false ),
+    profile_events( false ),
     canceled( false )
 #endif /* EVENT_QUEUE_DEBUG */
 {
-  allocated_events.reserve( 100 );
 }
 
 // event_manager_t::~event_manager_t ========================================
 
 event_manager_t::~event_manager_t()
 {
-  while ( recycled_event_list )
+  for ( auto arena : event_arenas )
+  {
+    free( arena );
+  }
+}
+
+// event_manager_t::allocate_slab ===========================================
+
+event_slab_t* event_manager_t::allocate_slab( unsigned size_class )
+{
+  if ( spare_event_slabs.empty() )
   {
-    event_t* e          = recycled_event_list;
-    recycled_event_list = e->next;
-    free( e );
+    void* arena = malloc( EVENT_SLAB_SIZE * ( EVENT_SLABS_PER_ARENA + 1 ) );
+    if ( !arena )
+    {
+      throw std::bad_alloc();
+    }
+    event_arenas.push_back( arena );
+
+    uintptr_t base = ( reinterpret_cast<uintptr_t>( arena ) + EVENT_SLAB_SIZE - 1 ) &
+                     ~( EVENT_SLAB_SIZE - 1 );
+    for ( size_t i = EVENT_SLABS_PER_ARENA; i > 0; --i )
+    {
+      spare_event_slabs.push_back( reinterpret_cast<event_slab_t*>( base + ( i - 1 ) * EVENT_SLAB_SIZE ) );
+    }
   }
+
+  event_slab_t* slab = new ( spare_event_slabs.back() ) event_slab_t( size_class );
+  spare_event_slabs.pop_back();
+  event_slabs.push_back( slab );
+  n_class_slabs[ size_class ]++;
+
+  // Thread all blocks of the new slab onto the free list of the size class
+  for ( unsigned i = slab->n_blocks; i > 0; --i )
+  {
+    event_t* e = slab->block( i - 1 );
+    e->next    = recycled_event_list[ size_class ];
+    recycled_event_list[ size_class ] = e;
+  }
+
+  return slab;
+}
+
+// event_manager_t::memory_usage ============================================
+
+size_t event_manager_t::memory_usage() const
+{
+  return event_arenas.size() * EVENT_SLAB_SIZE * ( EVENT_SLABS_PER_ARENA + 1 ) +
+         ( event_slabs.capacity() + spare_event_slabs.capacity() ) * sizeof( event_slab_t* ) +
+         ( timing_wheel.capacity() + timing_wheel_tail.capacity() ) * sizeof( event_t* );
 }
 
 // event_manager_t::allocate_event ==========================================
 
 void* event_manager_t::allocate_event( const std::size_t size )
 {
-  static const std::size_t SIZE = util::next_power_of_two( 2 * sizeof( event_t ) );
-  assert( SIZE > size );
-  (void)size;
+  unsigned size_class = 0;
+  while ( size_class < EVENT_SIZE_CLASSES && event_block_size( size_class ) < size )
+  {
+    size_class++;
+  }
+
+  assert( size_class < EVENT_SIZE_CLASSES && "Event too large for the event allocator" );
+  if ( size_class >= EVENT_SIZE_CLASSES )
+  {
+    throw std::bad_alloc();
+  }
 
-  event_t* e = recycled_event_list;
+  n_class_requests[ size_class ]++;
 #ifdef EVENT_QUEUE_DEBUG
   n_requested_events++;
   if ( size >= event_requested_size_count.size() )
@@ -149,27 +349,19 @@ void* event_manager_t::allocate_event( const std::size_t size )
   }
   event_requested_size_count[ size ]++;
 #endif
-  if ( e )
-  {
-    recycled_event_list = e->next;
-  }
-  else
-  {
-    e = (event_t*)malloc( SIZE );
 
-    if ( !e )
-    {
-      throw std::bad_alloc();
-    }
-    else
-    {
+  if ( !recycled_event_list[ size_class ] )
+  {
+    allocate_slab( size_class );
 #ifdef EVENT_QUEUE_DEBUG
-      n_allocated_events++;
+    n_allocated_events += event_slabs.back()->n_blocks;
 #endif
-      allocated_events.push_back( e );
-    }
   }
 
+  event_t* e = recycled_event_list[ size_class ];
+  recycled_event_list[ size_class ] = e->next;
+  event_slab_t::slab_of( e )->acquire( e );
+
   return e;
 }
 
@@ -178,9 +370,12 @@ void* event_manager_t::allocate_event( const std::size_t size )
 void event_manager_t::recycle_event( event_t* e )
 {
   e->~event_t();
-  e->recycled         = true;
-  e->next             = recycled_event_list;
-  recycled_event_list = e;
+  e->recycled = true;
+
+  event_slab_t* slab = event_slab_t::slab_of( e );
+  slab->release( e );
+  e->next = recycled_event_list[ slab->size_class ];
+  recycled_event_list[ slab->size_class ] = e;
 }
 
 // event_manager_t::add_event ===============================================
@@ -204,25 +399,67 @@ void event_manager_t::add_event( event_t* e, timespan_t delta_time )
     e->reschedule_time = timespan_t::zero();
   }
 
-  // Determine the timing wheel position to which the event will belong
-  // Only valid for integer based timespan_t
-  uint32_t slice = static_cast<uint32_t>(
-      ( e->time.total_millis() >> wheel_shift ) & wheel_mask );
-
-  // Insert event into the event list at the appropriate time
-  event_t** prev = &( timing_wheel[ slice ] );
 #ifdef EVENT_QUEUE_DEBUG
   unsigned traversed = 0;
+  bool tail_insert = true;
 #endif
 
-  while ( ( *prev ) &&
-          ( *prev )->time <= e->time )  // Find position in the list
+  if ( queue_type == EVENT_QUEUE_RADIX_HEAP )
+  {
+    // O(1) insert into the bucket selected by the highest bit differing from
+    // the last extracted key.
+    event_t*& bucket = radix_bucket[ radix_bucket_index( radix_key( e ), radix_last ) ];
+    e->next = bucket;
+    bucket  = e;
+  }
+  else
   {
-    prev = &( ( *prev )->next );
+    // Determine the timing wheel position to which the event will belong
+    // Only valid for integer based timespan_t
+    uint32_t slice = static_cast<uint32_t>(
+        ( e->time.total_millis() >> wheel_shift ) & wheel_mask );
+
+    // The ladder queue only keeps the slice currently being drained sorted,
+    // every other slice is an unsorted list that is sorted once when reached
+    if ( queue_type == EVENT_QUEUE_LADDER && slice != timing_slice )
+    {
+      if ( timing_wheel[ slice ] )
+      {
+        timing_wheel_tail[ slice ]->next = e;
+      }
+      else
+      {
+        timing_wheel[ slice ] = e;
+      }
+      timing_wheel_tail[ slice ] = e;
+    }
+    else
+    {
+      // Insert event into the event list at the appropriate time
+      event_t** prev = &( timing_wheel[ slice ] );
+
+      while ( ( *prev ) &&
+              ( *prev )->time <= e->time )  // Find position in the list
+      {
+        prev = &( ( *prev )->next );
 #ifdef EVENT_QUEUE_DEBUG
-    traversed++;
+        traversed++;
 #endif
+      }
+#ifdef EVENT_QUEUE_DEBUG
+      tail_insert = !( *prev );
+#endif
+      // insert event
+      e->next = *prev;
+      *prev   = e;
+
+      if ( queue_type == EVENT_QUEUE_LADDER && !e->next )
+      {
+        timing_wheel_tail[ slice ] = e;
+      }
+    }
   }
+
 #ifdef EVENT_QUEUE_DEBUG
   events_added++;
   events_traversed += traversed;
@@ -235,7 +472,7 @@ void event_manager_t::add_event( event_t* e, timespan_t delta_time )
     event_queue_depth_samples.resize( traversed + 1 );
   }
   event_queue_depth_samples[ traversed ].first++;
-  if ( !(*prev) )
+  if ( tail_insert )
   {
     event_queue_depth_samples[ traversed ].second++;
     if ( traversed )
@@ -244,9 +481,6 @@ void event_manager_t::add_event( event_t* e, timespan_t delta_time )
     }
   }
 #endif
-  // insert event
-  e->next = *prev;
-  *prev   = e;
 
   if ( ++events_remaining > max_events_remaining )
     max_events_remaining = events_remaining;
@@ -327,6 +561,12 @@ bool event_manager_t::execute()
         e->execute();
         sw.accumulate();
       }
+      else if ( profile )
+      {
+        auto start = event_profile_t::clock_type::now();
+        e->execute();
+        profile->add( event_profile_t::PROFILE_EVENT, nullptr, e->name(), event_profile_t::clock_type::now() - start );
+      }
       else
       {
         e->execute();
@@ -362,17 +602,40 @@ void event_manager_t::cancel()
 
 void event_manager_t::flush()
 {
-  for ( auto e : allocated_events )
+  // Only slabs with live blocks are visited, and only their live blocks are
+  // recycled, so the flush cost follows the number of outstanding events
+  // instead of every event ever allocated.
+  for ( auto slab : event_slabs )
   {
-    if ( e->recycled )
+    if ( slab->live == 0 )
       continue;
-    event_t* null_e = e;  // necessary evil
-    event_t::cancel( null_e );
-    recycle_event( e );
+
+    for ( size_t word = 0; word < slab->live_mask.size(); ++word )
+    {
+      uint64_t mask = slab->live_mask[ word ];
+      for ( unsigned bit = 0; mask; ++bit, mask >>= 1 )
+      {
+        if ( !( mask & 1 ) )
+          continue;
+
+        event_t* e = slab->block( static_cast<unsigned>( word * 64 + bit ) );
+
+        // Clear the wheel slice holding the event while its time is still valid
+        if ( queue_type != EVENT_QUEUE_RADIX_HEAP && e->scheduled )
+        {
+          uint32_t slice = static_cast<uint32_t>(
+              ( e->time.total_millis() >> wheel_shift ) & wheel_mask );
+          timing_wheel[ slice ] = nullptr;
+        }
+
+        event_t* null_e = e;  // necessary evil
+        event_t::cancel( null_e );
+        recycle_event( e );
+      }
+    }
   }
 
-  // Clear Timing Wheel
-  timing_wheel.assign( timing_wheel.size(), nullptr );
+  radix_bucket.fill( nullptr );
 }
 
 // event_manager_t::init ====================================================
@@ -404,6 +667,15 @@ void event_manager_t::init()
   // The timing wheel represents an array of event lists: Each time slice has an
   // event list.
   timing_wheel.resize( wheel_size );
+  if ( queue_type == EVENT_QUEUE_LADDER )
+  {
+    timing_wheel_tail.resize( wheel_size );
+  }
+
+  if ( profile_events )
+  {
+    profile = std::unique_ptr<event_profile_t>( new event_profile_t() );
+  }
 }
 
 // event_manager_t::next_event ==============================================
@@ -413,6 +685,11 @@ event_t* event_manager_t::next_event()
   if ( events_remaining == 0 )
     return nullptr;
 
+  if ( queue_type == EVENT_QUEUE_RADIX_HEAP )
+  {
+    return next_radix_event();
+  }
+
   while ( true )
   {
     event_t*& event_list = timing_wheel[ timing_slice ];
@@ -431,11 +708,61 @@ event_t* event_manager_t::next_event()
       timing_slice = 0;
       // Time Wheel turns around.
     }
+
+    // Ladder queue: the slice becomes the sorted bottom rung once reached
+    if ( queue_type == EVENT_QUEUE_LADDER && timing_wheel[ timing_slice ] )
+    {
+      timing_wheel[ timing_slice ] = sort_event_list( timing_wheel[ timing_slice ] );
+    }
   }
 
   return nullptr;
 }
 
+// event_manager_t::next_radix_event ========================================
+
+event_t* event_manager_t::next_radix_event()
+{
+  if ( ! radix_bucket[ 0 ] )
+  {
+    // Find the lowest non-empty bucket, its minimum becomes the new reference
+    // key and all of its events are redistributed into strictly lower buckets.
+    size_t bucket = 1;
+    while ( ! radix_bucket[ bucket ] )
+    {
+      ++bucket;
+    }
+
+    event_t* list = radix_bucket[ bucket ];
+    radix_bucket[ bucket ] = nullptr;
+
+    uint64_t min_key = radix_key( list );
+    for ( event_t* e = list->next; e; e = e->next )
+    {
+      min_key = std::min( min_key, radix_key( e ) );
+    }
+    radix_last = min_key;
+
+    while ( list )
+    {
+      event_t* e = list;
+      list = e->next;
+      event_t*& target = radix_bucket[ radix_bucket_index( radix_key( e ), radix_last ) ];
+      e->next = target;
+      target = e;
+#ifdef EVENT_QUEUE_DEBUG
+      events_traversed++;
+#endif
+    }
+  }
+
+  event_t* e = radix_bucket[ 0 ];
+  radix_bucket[ 0 ] = e->next;
+  events_remaining--;
+  events_processed++;
+  return e;
+}
+
 // event_manager_t::reset ===================================================
 
 void event_manager_t::reset()
@@ -443,6 +770,7 @@ void event_manager_t::reset()
   events_remaining = 0;
   events_processed = 0;
   timing_slice     = 0;
+  radix_last       = 0;
   global_event_id  = 0;
   canceled         = false;
   current_time     = timespan_t::zero();
@@ -455,6 +783,15 @@ void event_manager_t::merge( event_manager_t& other )
   max_events_remaining =
       std::max( max_events_remaining, other.max_events_remaining );
   total_events_processed += other.total_events_processed;
+  for ( unsigned i = 0; i < EVENT_SIZE_CLASSES; ++i )
+  {
+    n_class_requests[ i ] += other.n_class_requests[ i ];
+    n_class_slabs[ i ] += other.n_class_slabs[ i ];
+  }
+  if ( profile && other.profile )
+  {
+    profile -> merge( *other.profile );
+  }
 #ifdef EVENT_QUEUE_DEBUG
   events_traversed += other.events_traversed;
   events_added += other.events_added;
@@ -486,3 +823,100 @@ void event_manager_t::merge( event_manager_t& other )
 
 #endif
 }
+
+// event_profile_t::category_string =========================================
+
+const char* event_profile_t::category_string( category_e c )
+{
+  switch ( c )
+  {
+    case PROFILE_EVENT:          return "Event";
+    case PROFILE_ACTION_EXECUTE: return "Action Execute";
+    case PROFILE_ACTION_TICK:    return "Action Tick";
+    case PROFILE_BUFF_TRIGGER:   return "Buff Trigger";
+    case PROFILE_BUFF_EXPIRE:    return "Buff Expire";
+    default:                     return "Unknown";
+  }
+}
+
+// event_profile_t::sample_name =============================================
+
+std::string event_profile_t::sample_name( const sample_key_t& k )
+{
+  if ( k.actor )
+  {
+    return std::string( k.actor -> name() ) + "/" + k.name;
+  }
+
+  return k.name;
+}
+
+// event_profile_t::collect =================================================
+
+void event_profile_t::collect( category_e c, std::map<std::string, sample_t>& out ) const
+{
+  out = merged[ c ];
+  for ( const auto& entry : samples[ c ] )
+  {
+    auto& sample = out[ sample_name( entry.first ) ];
+    sample.count += entry.second.count;
+    sample.nanoseconds += entry.second.nanoseconds;
+  }
+}
+
+// event_profile_t::merge ===================================================
+
+// The samples of the other profile are keyed by objects of its own thread, which do not outlive
+// the merge, so they are folded in by name
+void event_profile_t::merge( const event_profile_t& other )
+{
+  for ( size_t c = 0; c < PROFILE_MAX; ++c )
+  {
+    std::map<std::string, sample_t> other_samples;
+    other.collect( static_cast<category_e>( c ), other_samples );
+    for ( const auto& entry : other_samples )
+    {
+      auto& sample = merged[ c ][ entry.first ];
+      sample.count += entry.second.count;
+      sample.nanoseconds += entry.second.nanoseconds;
+    }
+  }
+}
+
+// event_profile_t::entries =================================================
+
+std::vector<event_profile_t::entry_t> event_profile_t::entries( category_e c ) const
+{
+  std::map<std::string, sample_t> all;
+  collect( c, all );
+
+  std::vector<entry_t> result;
+  result.reserve( all.size() );
+  for ( const auto& entry : all )
+  {
+    entry_t e;
+    e.name = entry.first;
+    e.count = entry.second.count;
+    e.nanoseconds = entry.second.nanoseconds;
+    result.push_back( e );
+  }
+
+  range::sort( result, []( const entry_t& l, const entry_t& r ) {
+    return l.nanoseconds > r.nanoseconds;
+  } );
+
+  return result;
+}
+
+// event_profile_t::total_nanoseconds =======================================
+
+uint64_t event_profile_t::total_nanoseconds( category_e c ) const
+{
+  uint64_t total = 0;
+  for ( const auto& entry : merged[ c ] )
+    total += entry.second.nanoseconds;
+  for ( const auto& entry : samples[ c ] )
+    total += entry.second.nanoseconds;
+
+  return total;
+}
@@ -36,6 +36,12 @@ public:
   {
     return F()( input->eval() );
   }
+
+  void compile( program_t& prog ) override
+  {
+    input->compile( prog );
+    prog.emit_unary( op_ );
+  }
 };
 
 namespace unary
@@ -142,6 +148,15 @@ public:
   {
     return left->eval() && right->eval();
   }
+
+  void compile( program_t& prog ) override
+  {
+    left->compile( prog );
+    size_t jump = prog.emit_jump( program_t::OP_JUMP_FALSE );
+    right->compile( prog );
+    prog.emit_bool();
+    prog.patch_jump( jump );
+  }
 };
 
 class logical_or_t : public binary_base_t
@@ -156,6 +171,15 @@ public:
   {
     return left->eval() || right->eval();
   }
+
+  void compile( program_t& prog ) override
+  {
+    left->compile( prog );
+    size_t jump = prog.emit_jump( program_t::OP_JUMP_TRUE );
+    right->compile( prog );
+    prog.emit_bool();
+    prog.patch_jump( jump );
+  }
 };
 
 class logical_xor_t : public binary_base_t
@@ -170,6 +194,13 @@ public:
   {
     return bool( left->eval() != 0 ) != bool( right->eval() != 0 );
   }
+
+  void compile( program_t& prog ) override
+  {
+    left->compile( prog );
+    right->compile( prog );
+    prog.emit_binary( op_ );
+  }
 };
 
 template <template <typename> class F>
@@ -185,6 +216,13 @@ public:
   {
     return F<double>()( left->eval(), right->eval() );
   }
+
+  void compile( program_t& prog ) override
+  {
+    left->compile( prog );
+    right->compile( prog );
+    prog.emit_binary( op_ );
+  }
 };
 
 expr_t* select_binary( const std::string& name, token_e op, expr_t* left,
@@ -738,6 +776,12 @@ public:
         {
           return F<double>()( left, right->eval() );
         }
+        void compile( program_t& prog ) override
+        {
+          prog.emit_const( left );
+          right->compile( prog );
+          prog.emit_binary( op_ );
+        }
         ~left_reduced_t()
         { delete right; }
       };
@@ -765,6 +809,12 @@ public:
         {
           return F<double>()( left->eval(), right );
         }
+        void compile( program_t& prog ) override
+        {
+          left->compile( prog );
+          prog.emit_const( right );
+          prog.emit_binary( op_ );
+        }
         ~right_reduced_t()
         { delete left; }
       };
@@ -1290,6 +1340,260 @@ expr_t* build_player_expression_tree(
   return res;
 }
 
+// Expression Programs ======================================================
+
+void program_t::emit( opcode_e op, int stack_change )
+{
+  push( op, stack_change );
+}
+
+program_t::instruction_t& program_t::push( opcode_e op, int stack_change )
+{
+  depth += stack_change;
+  max_depth = std::max( max_depth, depth );
+  instruction_t instr;
+  instr.op     = op;
+  instr.target = 0;
+  if ( op >= OP_LOAD_DOUBLE && op <= OP_LOAD_READY )
+    inputs.push_back( code.size() );
+  code.push_back( instr );
+  return code.back();
+}
+
+void program_t::emit_const( double value )
+{
+  push( OP_CONST, 1 ).value = value;
+}
+
+void program_t::emit_call( expr_t* expr )
+{
+  opaque = true;
+  push( OP_CALL, 1 ).expr = expr;
+}
+
+void program_t::emit_load( expr_t*, const double& v )
+{
+  push( OP_LOAD_DOUBLE, 1 ).d = &v;
+}
+
+void program_t::emit_load( expr_t*, const int& v )
+{
+  push( OP_LOAD_INT, 1 ).i = &v;
+}
+
+void program_t::emit_load( expr_t*, const unsigned& v )
+{
+  push( OP_LOAD_UNSIGNED, 1 ).u = &v;
+}
+
+void program_t::emit_load( expr_t*, const bool& v )
+{
+  push( OP_LOAD_BOOL, 1 ).b = &v;
+}
+
+void program_t::emit_load( expr_t*, const timespan_t& v )
+{
+  push( OP_LOAD_TIMESPAN, 1 ).t = &v;
+}
+
+void program_t::emit_load_positive( const int& v, bool positive )
+{
+  push( positive ? OP_LOAD_INT_POSITIVE : OP_LOAD_INT_NOT_POSITIVE, 1 ).i = &v;
+}
+
+void program_t::emit_load_ready( expr_t* expr, const timespan_t& v )
+{
+  if ( !clock )
+    emit_call( expr );
+  else
+    push( OP_LOAD_READY, 1 ).t = &v;
+}
+
+void program_t::emit_bool()
+{
+  emit( OP_BOOL, 0 );
+}
+
+void program_t::emit_unary( token_e op )
+{
+  switch ( op )
+  {
+    case TOK_MINUS: emit( OP_NEG, 0 ); break;
+    case TOK_NOT:   emit( OP_NOT, 0 ); break;
+    case TOK_ABS:   emit( OP_ABS, 0 ); break;
+    case TOK_FLOOR: emit( OP_FLOOR, 0 ); break;
+    case TOK_CEIL:  emit( OP_CEIL, 0 ); break;
+    default:
+      assert( false );
+      break;
+  }
+}
+
+void program_t::emit_binary( token_e op )
+{
+  switch ( op )
+  {
+    case TOK_ADD:   emit( OP_ADD, -1 ); break;
+    case TOK_SUB:   emit( OP_SUB, -1 ); break;
+    case TOK_MULT:  emit( OP_MULT, -1 ); break;
+    case TOK_DIV:   emit( OP_DIV, -1 ); break;
+    case TOK_MAX:   emit( OP_MAX, -1 ); break;
+    case TOK_MIN:   emit( OP_MIN, -1 ); break;
+    case TOK_EQ:    emit( OP_EQ, -1 ); break;
+    case TOK_NOTEQ: emit( OP_NOTEQ, -1 ); break;
+    case TOK_LT:    emit( OP_LT, -1 ); break;
+    case TOK_LTEQ:  emit( OP_LTEQ, -1 ); break;
+    case TOK_GT:    emit( OP_GT, -1 ); break;
+    case TOK_GTEQ:  emit( OP_GTEQ, -1 ); break;
+    case TOK_XOR:   emit( OP_XOR, -1 ); break;
+    default:
+      assert( false );
+      break;
+  }
+}
+
+// The conditional jumps leave the value on the stack when taken, and drop it
+// when falling through to the right hand side.
+size_t program_t::emit_jump( opcode_e op )
+{
+  assert( op == OP_JUMP_FALSE || op == OP_JUMP_TRUE );
+  push( op, -1 );
+  return code.size() - 1;
+}
+
+void program_t::patch_jump( size_t at )
+{
+  assert( at < code.size() );
+  code[ at ].target = code.size();
+}
+
+double program_t::run() const
+{
+  double stack[ MAX_DEPTH ];
+  double* top = stack - 1;
+  const instruction_t* begin = code.data();
+  const instruction_t* end = begin + code.size();
+
+  for ( const instruction_t* pc = begin; pc != end; ++pc )
+  {
+    switch ( pc -> op )
+    {
+      case OP_CONST:                 *++top = pc -> value; break;
+      case OP_LOAD_DOUBLE:           *++top = *pc -> d; break;
+      case OP_LOAD_INT:              *++top = *pc -> i; break;
+      case OP_LOAD_UNSIGNED:         *++top = *pc -> u; break;
+      case OP_LOAD_BOOL:             *++top = *pc -> b; break;
+      case OP_LOAD_TIMESPAN:         *++top = pc -> t -> total_seconds(); break;
+      case OP_LOAD_INT_POSITIVE:     *++top = *pc -> i > 0; break;
+      case OP_LOAD_INT_NOT_POSITIVE: *++top = *pc -> i <= 0; break;
+      case OP_LOAD_READY:            *++top = *pc -> t <= *clock; break;
+      case OP_CALL:                  *++top = pc -> expr -> eval(); break;
+      case OP_NEG:   *top = -*top; break;
+      case OP_NOT:   *top = !*top; break;
+      case OP_ABS:   *top = std::fabs( *top ); break;
+      case OP_FLOOR: *top = std::floor( *top ); break;
+      case OP_CEIL:  *top = std::ceil( *top ); break;
+      case OP_BOOL:  *top = *top != 0; break;
+      case OP_ADD:   top[ -1 ] = top[ -1 ] + top[ 0 ]; --top; break;
+      case OP_SUB:   top[ -1 ] = top[ -1 ] - top[ 0 ]; --top; break;
+      case OP_MULT:  top[ -1 ] = top[ -1 ] * top[ 0 ]; --top; break;
+      case OP_DIV:   top[ -1 ] = top[ -1 ] / top[ 0 ]; --top; break;
+      case OP_MAX:   top[ -1 ] = std::max( top[ -1 ], top[ 0 ] ); --top; break;
+      case OP_MIN:   top[ -1 ] = std::min( top[ -1 ], top[ 0 ] ); --top; break;
+      case OP_EQ:    top[ -1 ] = top[ -1 ] == top[ 0 ]; --top; break;
+      case OP_NOTEQ: top[ -1 ] = top[ -1 ] != top[ 0 ]; --top; break;
+      case OP_LT:    top[ -1 ] = top[ -1 ] < top[ 0 ]; --top; break;
+      case OP_LTEQ:  top[ -1 ] = top[ -1 ] <= top[ 0 ]; --top; break;
+      case OP_GT:    top[ -1 ] = top[ -1 ] > top[ 0 ]; --top; break;
+      case OP_GTEQ:  top[ -1 ] = top[ -1 ] >= top[ 0 ]; --top; break;
+      case OP_XOR:
+        top[ -1 ] = bool( top[ -1 ] != 0 ) != bool( top[ 0 ] != 0 );
+        --top;
+        break;
+      case OP_JUMP_FALSE:
+        if ( *top == 0 )
+        {
+          *top = 0;
+          pc   = begin + pc -> target - 1;
+        }
+        else
+          --top;
+        break;
+      case OP_JUMP_TRUE:
+        if ( *top != 0 )
+        {
+          *top = 1;
+          pc   = begin + pc -> target - 1;
+        }
+        else
+          --top;
+        break;
+    }
+  }
+
+  assert( top == stack );
+  return *top;
+}
+
+// Value a load instruction reads. Ready times are compared against the clock
+// through the cache expiry instead.
+double program_t::input( const instruction_t& instr ) const
+{
+  switch ( instr.op )
+  {
+    case OP_LOAD_DOUBLE:           return *instr.d;
+    case OP_LOAD_INT:              return *instr.i;
+    case OP_LOAD_UNSIGNED:         return *instr.u;
+    case OP_LOAD_BOOL:             return *instr.b;
+    case OP_LOAD_TIMESPAN:         return instr.t -> total_seconds();
+    case OP_LOAD_INT_POSITIVE:     return *instr.i > 0;
+    case OP_LOAD_INT_NOT_POSITIVE: return *instr.i <= 0;
+    case OP_LOAD_READY:            return instr.t -> total_seconds();
+    default:
+      assert( false );
+      return 0;
+  }
+}
+
+double program_t::run_cached( bool& hit )
+{
+  assert( cacheable() );
+
+  hit = cache_valid && *clock < cache_expiry;
+  for ( size_t i = 0; hit && i < inputs.size(); ++i )
+    hit = input( code[ inputs[ i ] ] ) == snapshot[ i ];
+
+  if ( hit )
+    return cache_value;
+
+  snapshot.resize( inputs.size() );
+  cache_expiry = timespan_t::max();
+  for ( size_t i = 0; i < inputs.size(); ++i )
+  {
+    const instruction_t& instr = code[ inputs[ i ] ];
+    snapshot[ i ] = input( instr );
+    if ( instr.op == OP_LOAD_READY && *instr.t > *clock )
+      cache_expiry = std::min( cache_expiry, *instr.t );
+  }
+
+  cache_value = run();
+  cache_valid = true;
+  return cache_value;
+}
+
+std::unique_ptr<program_t> compile( expr_t* expr, const timespan_t* clock )
+{
+  if ( !expr )
+    return nullptr;
+
+  std::unique_ptr<program_t> prog( new program_t( clock ) );
+  expr->compile( *prog );
+  if ( !prog->valid() )
+    return nullptr;
+
+  return prog;
+}
+
 }  // expression
 
 #if !defined( NDEBUG )
@@ -1442,6 +1746,16 @@ void time_test( expr_t* expr, uint64_t n )
     value            = expr->eval();
   const int64_t stop = util::milliseconds();
   printf( "evaluate: %f in %.4f seconds\n", value, ( stop - start ) / 1000.0 );
+
+  if ( auto prog = expression::compile( expr ) )
+  {
+    const int64_t compiled_start = util::milliseconds();
+    for ( uint64_t i = 0; i < n; ++i )
+      value = prog->run();
+    const int64_t compiled_stop = util::milliseconds();
+    printf( "compiled: %f in %.4f seconds\n", value,
+            ( compiled_stop - compiled_start ) / 1000.0 );
+  }
 }
 }
 
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
 
 #include "sc_timespan.hpp"
 
@@ -73,6 +74,152 @@ bool convert_to_rpn( std::vector<expr_token_t>& tokens );
 expr_t* build_player_expression_tree(
     player_t& player, std::vector<expression::expr_token_t>& tokens,
     bool optimize );
+
+/// Flat postfix program lowered from an optimized expression tree. Evaluated by
+/// a single interpreter loop instead of one virtual call per tree node; leaves
+/// that refer to plain values are read through direct pointers.
+class program_t
+{
+public:
+  enum opcode_e : uint8_t
+  {
+    OP_CONST,
+    OP_LOAD_DOUBLE,
+    OP_LOAD_INT,
+    OP_LOAD_UNSIGNED,
+    OP_LOAD_BOOL,
+    OP_LOAD_TIMESPAN,
+    OP_LOAD_INT_POSITIVE,
+    OP_LOAD_INT_NOT_POSITIVE,
+    OP_LOAD_READY,
+    OP_CALL,
+    OP_NEG,
+    OP_NOT,
+    OP_ABS,
+    OP_FLOOR,
+    OP_CEIL,
+    OP_ADD,
+    OP_SUB,
+    OP_MULT,
+    OP_DIV,
+    OP_MAX,
+    OP_MIN,
+    OP_EQ,
+    OP_NOTEQ,
+    OP_LT,
+    OP_LTEQ,
+    OP_GT,
+    OP_GTEQ,
+    OP_XOR,
+    OP_BOOL,
+    OP_JUMP_FALSE,  // Keep a false value and jump, otherwise drop it
+    OP_JUMP_TRUE    // Replace a true value with 1 and jump, otherwise drop it
+  };
+
+  /// Maximum stack depth a program may use
+  static const int MAX_DEPTH = 64;
+
+  program_t( const timespan_t* clock_ = nullptr )
+    : clock( clock_ ),
+      depth( 0 ),
+      max_depth( 0 ),
+      opaque( false ),
+      cache_valid( false ),
+      cache_value( 0 ),
+      cache_expiry( timespan_t::zero() )
+  {
+  }
+
+  void emit_const( double value );
+  void emit_call( expr_t* expr );
+  void emit_load( expr_t*, const double& v );
+  void emit_load( expr_t*, const int& v );
+  void emit_load( expr_t*, const unsigned& v );
+  void emit_load( expr_t*, const bool& v );
+  void emit_load( expr_t*, const timespan_t& v );
+  /// Values without a direct load are evaluated through the expression
+  template <typename T>
+  void emit_load( expr_t* expr, const T& )
+  {
+    emit_call( expr );
+  }
+  /// Integer compared against zero, e.g. buff stacks for buff.x.up / down
+  void emit_load_positive( const int& v, bool positive );
+  /// Timestamp that has been reached, e.g. cooldown ready time for cooldown.x.up.
+  /// Requires the program clock, otherwise expr is called.
+  void emit_load_ready( expr_t* expr, const timespan_t& v );
+  /// Normalize the top of the stack to 0 or 1
+  void emit_bool();
+  void emit_unary( token_e op );
+  void emit_binary( token_e op );
+  size_t emit_jump( opcode_e op );
+  void patch_jump( size_t at );
+
+  bool valid() const
+  {
+    return max_depth <= MAX_DEPTH;
+  }
+  size_t size() const
+  {
+    return code.size();
+  }
+
+  double run() const;
+
+  /// A program is cacheable when every value it reads is known to it, i.e. no
+  /// expression had to be called through evaluate().
+  bool cacheable() const
+  {
+    return !opaque && clock;
+  }
+  /// Run the program, returning the previous result while none of the values
+  /// it reads have changed and the clock has not reached the expiry time of a
+  /// time dependent input. hit tells if the previous result was reused.
+  double run_cached( bool& hit );
+  void invalidate()
+  {
+    cache_valid = false;
+  }
+
+private:
+  struct instruction_t
+  {
+    opcode_e op;
+    union
+    {
+      double value;
+      const double* d;
+      const int* i;
+      const unsigned* u;
+      const bool* b;
+      const timespan_t* t;
+      expr_t* expr;
+      size_t target;
+    };
+  };
+
+  std::vector<instruction_t> code;
+  const timespan_t* clock;
+  int depth, max_depth;
+  bool opaque;
+
+  // Result cache, with one input value per load instruction
+  std::vector<size_t> inputs;
+  std::vector<double> snapshot;
+  bool cache_valid;
+  double cache_value;
+  timespan_t cache_expiry;
+
+  double input( const instruction_t& instr ) const;
+
+  void emit( opcode_e op, int stack_change );
+  instruction_t& push( opcode_e op, int stack_change );
+};
+
+/// Compile expr into a program, returns nullptr if it does not fit one. Time
+/// dependent inputs are evaluated against clock.
+std::unique_ptr<program_t> compile( expr_t* expr,
+                                    const timespan_t* clock = nullptr );
 }
 
 /// Action expression
@@ -152,6 +299,13 @@ public:
   }
   virtual double evaluate() = 0;
 
+  /// Lower the expression into prog. Nodes without a lowering of their own are
+  /// called through evaluate().
+  virtual void compile( expression::program_t& prog )
+  {
+    prog.emit_call( this );
+  }
+
   virtual bool is_constant( double* /*return_value*/ )
   {
     return false;
@@ -183,6 +337,11 @@ public:
     return value;
   }
 
+  void compile( expression::program_t& prog ) override
+  {
+    prog.emit_const( value );
+  }
+
   bool is_constant( double* v ) override  // override
   {
     *v = value;
@@ -207,6 +366,11 @@ private:
   {
     return coerce( t );
   }
+
+  void compile( expression::program_t& prog ) override
+  {
+    prog.emit_load( this, t );
+  }
 };
 
 // Template to return a reference expression
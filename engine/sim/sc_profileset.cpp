@@ -12,6 +12,18 @@
 
 namespace
 {
+// Heap memory held by the option set of a profileset
+size_t options_memory_size( const sim_control_t& control )
+{
+  size_t bytes = sizeof( sim_control_t ) + control.options.capacity() * sizeof( option_tuple_t );
+  for ( const auto& opt : control.options )
+  {
+    bytes += opt.scope.capacity() + opt.name.capacity() + opt.value.capacity();
+  }
+
+  return bytes;
+}
+
 std::string format_time( double seconds, bool milliseconds = true )
 {
   std::stringstream s;
@@ -71,12 +83,15 @@ std::string format_time( double seconds, bool milliseconds = true )
   return s.str();
 }
 
-// Deallocating profile_sim is the responsibility of the caller (i.e., profileset driver or
-// worker_t)
-void simulate_profileset( sim_t* parent, profileset::profile_set_t& set, sim_t*& profile_sim )
+// Set up a newly constructed profileset sim, before it is initialized
+void prepare_profileset( sim_t* parent, const std::string& name, sim_t* profile_sim, int iterations )
 {
-  // Reset random seed for the profileset sims
-  profile_sim -> seed = 0;
+  // Reset random seed for the profileset sims, unless they simulate the random streams of the
+  // baseline
+  if ( ! parent -> profileset_crn )
+  {
+    profile_sim -> seed = 0;
+  }
   profile_sim -> profileset_enabled = true;
   profile_sim -> report_details = 0;
   if ( parent -> profileset_work_threads > 0 )
@@ -89,9 +104,34 @@ void simulate_profileset( sim_t* parent, profileset::profile_set_t& set, sim_t*&
   else
   {
     profile_sim -> progress_bar.set_base( "Profileset" );
-    profile_sim -> progress_bar.set_phase( set.name() );
+    profile_sim -> progress_bar.set_phase( name );
+  }
+
+  // Reduced iteration count of an adaptive racing round
+  if ( iterations > 0 )
+  {
+    profile_sim -> work_queue -> init( iterations );
   }
+}
+
+// Construct and initialize the simulator that runs a profileset. Initialization also validates the
+// profileset options. The settings inherited from the parent come from the snapshot taken in
+// profilesets_t::initialize, the parent may still be simulating the baseline.
+sim_t* create_profileset_sim( sim_t* parent, const std::string& name, sim_control_t* control, int iterations )
+{
+  auto profile_sim = std::unique_ptr<sim_t>( new sim_t( parent, 0, control,
+                                                        parent -> profilesets.parent_settings() ) );
+  prepare_profileset( parent, name, profile_sim.get(), iterations );
+  profile_sim -> init();
+
+  return profile_sim.release();
+}
 
+// Deallocating profile_sim is the responsibility of the caller (i.e., profileset driver or
+// worker_t). The profileset sim is already prepared and initialized by the profileset init
+// threads.
+void simulate_profileset( sim_t* parent, profileset::profile_set_t& set, sim_t*& profile_sim )
+{
   auto ret = profile_sim -> execute();
   if ( ret )
   {
@@ -109,6 +149,7 @@ void simulate_profileset( sim_t* parent, profileset::profile_set_t& set, sim_t*&
   }
 
   const auto player = profile_sim -> player_no_pet_list.data().front();
+  const auto parent_player = parent -> player_no_pet_list.data().front();
   auto progress = profile_sim -> progress( nullptr, 0 );
 
   range::for_each( parent -> profileset_metric, [ & ]( scale_metric_e metric ) {
@@ -123,11 +164,20 @@ void simulate_profileset( sim_t* parent, profileset::profile_set_t& set, sim_t*&
       .max( data.max )
       .stddev( data.std_dev )
       .iterations( progress.current_iterations );
+
+    if ( parent -> profileset_crn )
+    {
+      auto diff = profileset::paired_difference( parent_player, player, metric );
+
+      set.result( metric )
+        .mean_diff( diff.mean() )
+        .mean_diff_error( parent -> confidence_estimator * diff.mean_std_dev() )
+        .paired_iterations( diff.count() );
+    }
   } );
 
   if ( ! parent -> profileset_output_data.empty() )
   {
-    const auto parent_player = parent -> player_no_pet_list.data().front();
     range::for_each( parent -> profileset_output_data, [ & ]( const std::string& option ) {
         save_output_data( set, parent_player, player, option );
     } );
@@ -139,8 +189,13 @@ void simulate_profileset( sim_t* parent, profileset::profile_set_t& set, sim_t*&
   parent -> merge_time   += profile_sim -> merge_time;
   parent -> analyze_time += profile_sim -> analyze_time;
   parent -> event_mgr.total_events_processed += profile_sim -> event_mgr.total_events_processed;
+  parent -> profilesets.record_memory( *profile_sim );
 
-  set.cleanup_options();
+  // Adaptive racing may simulate the profileset again
+  if ( parent -> profileset_race_top == 0 )
+  {
+    parent -> profilesets.release_options( set );
+  }
 }
 
 void insert_data( highchart::bar_chart_t&   chart,
@@ -148,7 +203,8 @@ void insert_data( highchart::bar_chart_t&   chart,
                   const color::rgb&         c,
                   const profileset::statistical_data_t& data,
                   bool                      baseline,
-                  double                    baseline_median )
+                  double                    baseline_median,
+                  const std::string&        paired_diff = std::string() )
 {
   js::sc_js_t entry;
 
@@ -162,6 +218,10 @@ void insert_data( highchart::bar_chart_t&   chart,
   entry.set( "name", name );
   entry.set( "reldiff", baseline_median > 0 ? (data.median / baseline_median - 1.0) * 100 : 0);
   entry.set( "y", util::round( data.median ) );
+  if ( ! paired_diff.empty() )
+  {
+    entry.set( "paireddiff", paired_diff );
+  }
 
   chart.add( "series.0.data", entry );
 
@@ -285,9 +345,16 @@ sim_control_t* profilesets_t::create_sim_options( const sim_control_t*
   return options_copy;
 }
 
-profile_set_t::profile_set_t( const std::string& name, sim_control_t* opts, bool has_output ) :
-  m_name( name ), m_options( opts ), m_has_output( has_output ), m_output_data( nullptr )
+profile_set_t::profile_set_t( const std::string& name, sim_control_t* opts, bool has_output,
+                              sim_t* sim ) :
+  m_name( name ), m_options( opts ), m_has_output( has_output ), m_sim( sim ),
+  m_eliminated_iterations( 0 ), m_output_data( nullptr )
+{
+}
+
+sim_t* profile_set_t::release_sim()
 {
+  return m_sim.release();
 }
 
 sim_control_t* profile_set_t::options() const
@@ -382,7 +449,12 @@ void worker_t::execute()
 {
   try
   {
-    m_sim = new sim_t( m_parent, 0, m_profileset -> options() );
+    m_sim = m_profileset -> release_sim();
+    if ( m_sim == nullptr )
+    {
+      m_sim = create_profileset_sim( m_parent, m_profileset -> name(), m_profileset -> options(),
+                                     m_master -> race_iterations() );
+    }
 
     simulate_profileset( m_parent, *m_profileset, m_sim );
   }
@@ -467,13 +539,12 @@ void profilesets_t::generate_work( sim_t* parent, std::unique_ptr<profile_set_t>
 {
   if ( m_mode == SEQUENTIAL )
   {
-    auto original_opts = parent -> control;
-
-    parent -> control = ptr_set -> options();
-
-    sim_t* profile_sim = new sim_t( parent );
-
-    parent -> control = original_opts;
+    sim_t* profile_sim = ptr_set -> release_sim();
+    if ( profile_sim == nullptr )
+    {
+      profile_sim = create_profileset_sim( parent, ptr_set -> name(), ptr_set -> options(),
+                                           m_race_iterations );
+    }
 
     simulate_profileset( parent, *ptr_set.get(), profile_sim );
 
@@ -527,11 +598,24 @@ bool profilesets_t::parse( sim_t* sim )
       return false;
     }
 
-    m_mutex.lock();
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    // Keep only a bounded number of initialized profileset sims waiting for simulation
+    m_prepared.wait( lock, [ this, sim ]() {
+      return sim -> canceled || is_done() ||
+             m_profilesets.size() + m_preparing - m_work_index < m_max_prepared;
+    } );
+
+    if ( sim -> canceled || is_done() )
+    {
+      lock.unlock();
+      set_state( DONE );
+      m_control.notify_one();
+      return false;
+    }
 
     if ( m_init_index == sim -> profileset_map.cend() )
     {
-      m_mutex.unlock();
       break;
     }
 
@@ -539,8 +623,9 @@ bool profilesets_t::parse( sim_t* sim )
     const auto& profileset_opts = m_init_index -> second;
 
     ++m_init_index;
+    ++m_preparing;
 
-    m_mutex.unlock();
+    lock.unlock();
 
     auto control = create_sim_options( m_original.get(), profileset_opts );
     if ( control == nullptr )
@@ -564,32 +649,37 @@ bool profilesets_t::parse( sim_t* sim )
              util::str_compare_ci( name, "json2" );
     } ) != profileset_opts.end();
 
-    // Test that profileset options are OK, up to the simulation initialization
+    sim_t* profile_sim = nullptr;
     try
     {
-      std::unique_ptr<sim_t> test_sim = std::unique_ptr<sim_t>(new sim_t());
-      test_sim -> profileset_enabled = true;
-
-      test_sim -> setup( control );
-      test_sim -> init();
+      profile_sim = create_profileset_sim( sim, profileset_name, control, m_race_iterations );
     }
     catch ( const std::exception& e )
     {
       std::cerr <<  "ERROR! Profileset '" << profileset_name << "' Setup failure: "
                 << e.what() << std::endl;
+      delete control;
       set_state( DONE );
       m_control.notify_one();
       return false;
     }
 
-    m_mutex.lock();
+    lock.lock();
+    m_options_memory += options_memory_size( *control );
+    m_peak_memory = std::max( m_peak_memory, m_options_memory );
     m_profilesets.push_back( std::unique_ptr<profile_set_t>(
-        new profile_set_t( profileset_name, control, has_output_opts ) ) );
+        new profile_set_t( profileset_name, control, has_output_opts, profile_sim ) ) );
+    --m_preparing;
     m_control.notify_one();
-    m_mutex.unlock();
   }
 
-  set_state( RUNNING );
+  // The last init thread to finish its profileset moves the profilesets to running state
+  std::unique_lock<std::mutex> lock( m_mutex );
+  if ( m_preparing == 0 && m_state == INITIALIZING )
+  {
+    m_state = RUNNING;
+    m_control.notify_one();
+  }
 
   return true;
 }
@@ -641,6 +731,17 @@ void profilesets_t::initialize( sim_t* sim )
 
   m_profilesets.reserve( sim -> profileset_map.size() + 1 );
 
+  // Adaptive racing simulates all profilesets with a reduced iteration count first
+  if ( sim -> profileset_race_top > 0 && sim -> profileset_race_iterations < sim -> iterations )
+  {
+    m_race_iterations = std::max( 1, sim -> profileset_race_iterations );
+  }
+
+  // Initialize profileset sims only a little ahead of the simulation, so that at most a few
+  // initialized simulators are kept in memory at any time
+  m_max_prepared = std::max( m_max_workers, size_t( 1 ) ) +
+                   as<size_t>( sim -> profileset_init_threads );
+
   // Generate a copy of the original control, and remove any and all profileset. options from it
   m_original = std::unique_ptr<sim_control_t>( new sim_control_t() );
 
@@ -650,6 +751,10 @@ void profilesets_t::initialize( sim_t* sim )
     return ! util::str_in_str_ci( opt.name, "profileset." );
   } );
 
+  // The baseline keeps running while profileset sims are initialized, capture what they inherit
+  // from it now
+  m_parent_settings = std::make_shared<const sim_parent_settings_t>( *sim );
+
   // Spawn initialization threads, and start parsing through the profilesets
   set_state( INITIALIZING );
 
@@ -670,6 +775,8 @@ void profilesets_t::cancel()
 {
   if ( ! is_done() )
   {
+    m_prepared.notify_all();
+
     range::for_each( m_thread, []( std::thread& thread ) {
       if ( thread.joinable() )
       {
@@ -688,6 +795,38 @@ void profilesets_t::set_state( state new_state )
   m_state = new_state;
 
   m_mutex.unlock();
+
+  m_prepared.notify_all();
+}
+
+size_t profilesets_t::memory_usage() const
+{
+  return m_options_memory;
+}
+
+size_t profilesets_t::peak_memory_usage() const
+{
+  return m_peak_memory;
+}
+
+void profilesets_t::record_memory( const sim_t& profile_sim )
+{
+  std::lock_guard<std::mutex> lock( m_mutex );
+
+  // Upper estimate, every running and prepared profileset sim is as large as this one
+  size_t n_sims = std::max( m_max_workers, size_t( 1 ) ) + m_max_prepared;
+  m_peak_memory = std::max( m_peak_memory, m_options_memory + n_sims * profile_sim.memory.peak_total );
+}
+
+void profilesets_t::release_options( profile_set_t& set )
+{
+  std::lock_guard<std::mutex> lock( m_mutex );
+
+  if ( set.options() )
+  {
+    m_options_memory -= options_memory_size( *set.options() );
+    set.cleanup_options();
+  }
 }
 
 std::string profilesets_t::current_profileset_name()
@@ -726,6 +865,13 @@ bool profilesets_t::iterate( sim_t* parent )
       m_control.wait( m_control_lock );
     }
 
+    // Initialization failed, nothing more to sim
+    if ( is_done() )
+    {
+      m_control_lock.unlock();
+      break;
+    }
+
     // Break out of iteration loop if all work has been done
     if ( is_running() )
     {
@@ -740,6 +886,8 @@ bool profilesets_t::iterate( sim_t* parent )
 
     m_control_lock.unlock();
 
+    m_prepared.notify_one();
+
     generate_work( parent, set );
   }
 
@@ -747,6 +895,11 @@ bool profilesets_t::iterate( sim_t* parent )
   // not need to finalize any work (all work has been done by the loop above)
   finalize_work();
 
+  if ( m_race_iterations > 0 )
+  {
+    race( parent );
+  }
+
   // Output profileset progressbar whenever we finish anything
   output_progressbar( parent );
 
@@ -755,11 +908,120 @@ bool profilesets_t::iterate( sim_t* parent )
 
   parent -> control = original_opts;
 
+  parent -> sample_memory_usage();
+
   set_state( DONE );
 
   return true;
 }
 
+// Adaptive racing (successive halving). After each round, drop the profilesets that are clearly
+// out of contention, and simulate the remaining ones again with twice the iterations, until only
+// the top profilesets remain or the full iteration count is reached.
+void profilesets_t::race( sim_t* parent )
+{
+  while ( ! parent -> canceled )
+  {
+    auto contenders = eliminate( parent );
+    if ( contenders == 0 )
+    {
+      break;
+    }
+
+    m_race_iterations *= 2;
+
+    auto final_round = contenders <= as<size_t>( parent -> profileset_race_top ) ||
+                       m_race_iterations >= parent -> iterations;
+    if ( final_round )
+    {
+      m_race_iterations = 0;
+    }
+
+    for ( auto& set : m_profilesets )
+    {
+      if ( ! set -> eliminated() && set -> results() > 0 )
+      {
+        generate_work( parent, set );
+      }
+    }
+
+    finalize_work();
+
+    if ( final_round )
+    {
+      break;
+    }
+  }
+
+  m_race_iterations = 0;
+
+  range::for_each( m_profilesets, [ this ]( profileset_entry_t& set ) { release_options( *set ); } );
+}
+
+// Eliminate the profilesets whose confidence interval is below the top profilesets, or below the
+// racing threshold relative to the baseline. Returns the number of profilesets still in contention.
+size_t profilesets_t::eliminate( sim_t* parent )
+{
+  struct bounds_t
+  {
+    profile_set_t* set;
+    double low, high;
+  };
+
+  auto metric = parent -> profileset_metric.front();
+  auto baseline = metric_data( parent -> player_no_pet_list.data().front(), metric ).mean;
+
+  std::vector<bounds_t> bounds;
+  for ( auto& set : m_profilesets )
+  {
+    const profile_set_t* ps = set.get();
+    if ( ps -> eliminated() || ps -> results() == 0 )
+    {
+      continue;
+    }
+
+    // Paired differences to the baseline are much tighter than the independent interval
+    const auto& result = ps -> result( metric );
+    double value = result.mean(), error = 0;
+    if ( result.paired_iterations() > 0 )
+    {
+      value = baseline + result.mean_diff();
+      error = result.mean_diff_error();
+    }
+    else if ( result.iterations() > 0 )
+    {
+      error = parent -> confidence_estimator * result.stddev() / std::sqrt( as<double>( result.iterations() ) );
+    }
+
+    bounds.push_back( { set.get(), value - error, value + error } );
+  }
+
+  auto cutoff = baseline * ( 1.0 + parent -> profileset_race_threshold / 100.0 );
+  auto top = as<size_t>( parent -> profileset_race_top );
+  if ( bounds.size() > top )
+  {
+    std::vector<double> low;
+    range::transform( bounds, std::back_inserter( low ), []( const bounds_t& b ) { return b.low; } );
+    std::nth_element( low.begin(), low.begin() + ( top - 1 ), low.end(), std::greater<double>() );
+    cutoff = std::max( cutoff, low[ top - 1 ] );
+  }
+
+  size_t contenders = 0;
+  for ( const auto& b : bounds )
+  {
+    if ( b.high < cutoff )
+    {
+      b.set -> eliminate( b.set -> result( metric ).iterations() );
+    }
+    else
+    {
+      ++contenders;
+    }
+  }
+
+  return contenders;
+}
+
 void profilesets_t::notify_worker()
 {
   m_work.notify_one();
@@ -791,9 +1053,10 @@ void profilesets_t::output_progressbar( const sim_t* parent ) const
   s << "Profilesets (" << m_max_workers << "*" << parent -> profileset_work_threads << "): ";
 
   auto done = done_profilesets();
-  auto pct = done / as<double>( m_profilesets.size() );
+  auto total = parent -> profileset_map.size();
+  auto pct = done / as<double>( total );
 
-  s << done << "/" << m_profilesets.size() << " ";
+  s << done << "/" << total << " ";
 
   std::string status = "[";
   status.insert( 1, parent -> progress_bar.steps, '.' );
@@ -814,7 +1077,7 @@ void profilesets_t::output_progressbar( const sim_t* parent ) const
 
   auto average_per_sim = m_total_elapsed / as<double>( done );
   auto elapsed = util::wall_time() - m_start_time;
-  auto work_left = m_profilesets.size() - done;
+  auto work_left = total - done;
   auto time_left = ( work_left / m_max_workers ) * average_per_sim;
 
   // Average time per done simulation
@@ -867,6 +1130,19 @@ void profilesets_t::output_json( const sim_t& sim, js::JsonOutput& root ) const
 
     obj[ "iterations" ] = as<uint64_t>( result.iterations() );
 
+    if ( profileset -> eliminated() )
+    {
+      obj[ "eliminated" ] = true;
+      obj[ "eliminated_iterations" ] = as<uint64_t>( profileset -> eliminated_iterations() );
+    }
+
+    if ( result.paired_iterations() > 0 )
+    {
+      obj[ "mean_diff" ] = result.mean_diff();
+      obj[ "mean_diff_error" ] = result.mean_diff_error();
+      obj[ "paired_iterations" ] = as<uint64_t>( result.paired_iterations() );
+    }
+
     if ( profileset -> results() > 1 )
     {
       auto results2 = obj[ "additional_metrics" ].make_array();
@@ -887,6 +1163,13 @@ void profilesets_t::output_json( const sim_t& sim, js::JsonOutput& root ) const
           obj2[ "first_quartile" ] = result.first_quartile();
           obj2[ "third_quartile" ] = result.third_quartile();
         }
+
+        if ( result.paired_iterations() > 0 )
+        {
+          obj2[ "mean_diff" ] = result.mean_diff();
+          obj2[ "mean_diff_error" ] = result.mean_diff_error();
+          obj2[ "paired_iterations" ] = as<uint64_t>( result.paired_iterations() );
+        }
       }
     }
 
@@ -914,8 +1197,17 @@ void profilesets_t::output_text( const sim_t& sim, std::ostream& out ) const
   generate_sorted_profilesets( results );
 
   range::for_each( results, [ &out ]( const profile_set_t* profileset ) {
-      fmt::print( out, "    {:-10.3f} : {:s}\n",
-      profileset -> result().median(), profileset -> name().c_str() );
+    const auto& result = profileset -> result();
+    fmt::print( out, "    {:-10.3f} : {:s}", result.median(), profileset -> name().c_str() );
+    if ( result.paired_iterations() > 0 )
+    {
+      fmt::print( out, " (mean vs baseline {:+.3f} +/- {:.3f})", result.mean_diff(), result.mean_diff_error() );
+    }
+    if ( profileset -> eliminated() )
+    {
+      fmt::print( out, " (eliminated after {} iterations)", profileset -> eliminated_iterations() );
+    }
+    fmt::print( out, "\n" );
   } );
 }
 
@@ -932,6 +1224,30 @@ void profilesets_t::output_html( const sim_t& sim, std::ostream& out ) const
 
   generate_chart( sim, out );
 
+  std::vector<const profile_set_t*> results;
+  generate_sorted_profilesets( results );
+
+  auto n_eliminated = range::count_if( results, []( const profile_set_t* p ) { return p -> eliminated(); } );
+  if ( n_eliminated > 0 )
+  {
+    out << "<h3>Eliminated early by adaptive racing (" << n_eliminated << ")</h3>\n";
+    out << "<table class=\"sc\">\n";
+    out << "<tr><th>Profile set</th><th>Median " << util::scale_metric_type_string( sim.profileset_metric.front() )
+        << "</th><th>Iterations</th></tr>\n";
+    for ( const auto profileset : results )
+    {
+      if ( ! profileset -> eliminated() )
+      {
+        continue;
+      }
+
+      out << "<tr><td class=\"left\">" << util::encode_html( profileset -> name() ) << "</td>"
+          << "<td class=\"right\">" << util::round( profileset -> result().median(), 1 ) << "</td>"
+          << "<td class=\"right\">" << profileset -> eliminated_iterations() << "</td></tr>\n";
+    }
+    out << "</table>\n";
+  }
+
   out << "</div>";
   out << "</div>";
 }
@@ -965,6 +1281,8 @@ bool profilesets_t::generate_chart( const sim_t& sim, std::ostream& out ) const
   // Bar color
   const auto& c = color::class_color( sim.player_no_pet_list.data().front() -> type );
   std::string chart_name = util::scale_metric_type_string( sim.profileset_metric.front() );
+  // With common random numbers, profilesets are labeled with their paired difference to the baseline
+  std::string baseline_label = sim.profileset_crn ? "baseline" : "";
 
   std::vector<const profile_set_t*> results;
   generate_sorted_profilesets( results );
@@ -983,7 +1301,9 @@ bool profilesets_t::generate_chart( const sim_t& sim, std::ostream& out ) const
     profileset.set( "yAxis.gridLineWidth", 0 );
     profileset.set( "xAxis.offset", data_label_width );
     profileset.set_title( "Profile sets (median " + chart_name + ")" );
-    profileset.set( "subtitle.text", "Baseline in red" );
+    profileset.set( "subtitle.text", sim.profileset_crn
+      ? "Baseline in red, mean difference to baseline with paired error"
+      : "Baseline in red" );
     profileset.set( "subtitle.style.color", "#AA0000" );
     profileset.set_yaxis_title( "Median " + chart_name );
     profileset.width_ = 1150;
@@ -1035,7 +1355,11 @@ bool profilesets_t::generate_chart( const sim_t& sim, std::ostream& out ) const
 
     profileset.set( "xAxis.labels.formatter", functor );
     profileset.value( "xAxis.labels.formatter" ).SetRawOutput( true );
-    if ( sim.chart_show_relative_difference ) {
+    if ( sim.profileset_crn )
+    {
+      profileset.set( "plotOptions.bar.dataLabels.format", "{y} ({point.paireddiff})" );
+    }
+    else if ( sim.chart_show_relative_difference ) {
         profileset.set( "plotOptions.bar.dataLabels.format", "{y} ({point.reldiff}%)");
     }
 
@@ -1046,16 +1370,22 @@ bool profilesets_t::generate_chart( const sim_t& sim, std::ostream& out ) const
 
       if ( ! inserted && data.median() <= baseline_data.median )
       {
-        insert_data( profileset, sim.player_no_pet_list.data().front() -> name(), c, baseline_data, true, baseline_data.median );
+        insert_data( profileset, sim.player_no_pet_list.data().front() -> name(), c, baseline_data, true, baseline_data.median, baseline_label );
         inserted = true;
       }
 
-      insert_data( profileset, set -> name(), c, set -> result().statistical_data(), false, baseline_data.median );
+      std::string paired_diff;
+      if ( data.paired_iterations() > 0 )
+      {
+        paired_diff = fmt::format( "{:+.1f} \u00b1 {:.1f}", data.mean_diff(), data.mean_diff_error() );
+      }
+
+      insert_data( profileset, set -> name(), c, set -> result().statistical_data(), false, baseline_data.median, paired_diff );
     }
 
     if ( inserted == false )
     {
-      insert_data( profileset, sim.player_no_pet_list.data().front() -> name(), c, baseline_data, true, baseline_data.median );
+      insert_data( profileset, sim.player_no_pet_list.data().front() -> name(), c, baseline_data, true, baseline_data.median, baseline_label );
     }
 
     out << profileset.to_string();
@@ -1105,6 +1435,10 @@ void create_options( sim_t* sim )
 
   sim -> add_option( opt_int( "profileset_work_threads", sim -> profileset_work_threads ) );
   sim -> add_option( opt_int( "profileset_init_threads", sim -> profileset_init_threads ) );
+  sim -> add_option( opt_bool( "profileset_crn", sim -> profileset_crn ) );
+  sim -> add_option( opt_int( "profileset_race_top", sim -> profileset_race_top, 0, std::numeric_limits<int>::max() ) );
+  sim -> add_option( opt_int( "profileset_race_iterations", sim -> profileset_race_iterations, 1, std::numeric_limits<int>::max() ) );
+  sim -> add_option( opt_float( "profileset_race_threshold", sim -> profileset_race_threshold ) );
 }
 
 statistical_data_t collect( const extended_sample_data_t& c )
@@ -1149,6 +1483,54 @@ statistical_data_t metric_data( const player_t* player, scale_metric_e metric )
   }
 }
 
+// Per-iteration samples of the metric, in the order of the collected iterations. Empty if the
+// metric does not keep its samples.
+std::vector<double> metric_samples( const player_t* player, scale_metric_e metric )
+{
+  const auto& d = player -> collected_data;
+
+  switch ( metric )
+  {
+    case SCALE_METRIC_DPS:       return d.dps.data();
+    case SCALE_METRIC_DPSE:      return d.dpse.data();
+    case SCALE_METRIC_HPS:       return d.hps.data();
+    case SCALE_METRIC_HPSE:      return d.hpse.data();
+    case SCALE_METRIC_APS:       return d.aps.data();
+    case SCALE_METRIC_DPSP:      return d.prioritydps.data();
+    case SCALE_METRIC_DTPS:      return d.dtps.data();
+    case SCALE_METRIC_DMG_TAKEN: return d.dmg_taken.data();
+    case SCALE_METRIC_HTPS:      return d.htps.data();
+    case SCALE_METRIC_TMI:       return d.theck_meloree_index.data();
+    case SCALE_METRIC_ETMI:      return d.effective_theck_meloree_index.data();
+    case SCALE_METRIC_DEATHS:    return d.deaths.data();
+    case SCALE_METRIC_HAPS:
+    {
+      auto samples = d.hps.data();
+      const auto& aps = d.aps.data();
+      if ( samples.size() != aps.size() )
+      {
+        return {};
+      }
+
+      for ( size_t i = 0; i < samples.size(); ++i )
+      {
+        samples[ i ] += aps[ i ];
+      }
+
+      return samples;
+    }
+    default:                     return {};
+  }
+}
+
+// Statistics of the per-iteration difference of the metric between player and baseline, over the
+// iterations both simulated with the same random stream. Empty if the sims share no iterations.
+running_sample_data_t paired_difference( const player_t* baseline, const player_t* player, scale_metric_e metric )
+{
+  return ::paired_difference( baseline -> collected_data.iteration_stream, metric_samples( baseline, metric ),
+                              player -> collected_data.iteration_stream, metric_samples( player, metric ) );
+}
+
 void save_output_data( profile_set_t& profileset, const player_t* parent_player, const player_t* player, std::string option )
 {
   // TODO: Make an enum to proper use a switch instead of if/else
@@ -1363,6 +1745,8 @@ void create_options( sim_t* ) {}
 sim_control_t* filter_control( const sim_control_t* ) { return nullptr; }
 void profilesets_t::initialize( sim_t* ) {}
 std::string profilesets_t::current_profileset_name() { return "DUMMY"; }
+size_t profilesets_t::memory_usage() const { return 0; }
+size_t profilesets_t::peak_memory_usage() const { return 0; }
 void profilesets_t::cancel() {}
 bool profilesets_t::iterate( sim_t*  ) { return true ;}
 void profilesets_t::output_json( const sim_t&, js::JsonOutput& ) const {}
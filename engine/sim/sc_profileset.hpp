@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #ifndef SC_NO_THREADING
 #include <thread>
@@ -21,8 +22,10 @@
 
 struct sim_t;
 struct sim_control_t;
+struct sim_parent_settings_t;
 struct player_t;
 class extended_sample_data_t;
+class running_sample_data_t;
 struct talent_data_t;
 
 namespace js {
@@ -49,14 +52,20 @@ class profile_result_t
   double         m_3rdquartile;
   double         m_stddev;
   size_t         m_iterations;
+  // Paired difference to the baseline, over iterations simulated with common random numbers
+  double         m_mean_diff;
+  double         m_mean_diff_error;
+  size_t         m_paired_iterations;
 
 public:
   profile_result_t() : m_metric( SCALE_METRIC_NONE ), m_mean( 0 ), m_median( 0 ), m_min( 0 ),
-    m_max( 0 ), m_1stquartile( 0 ), m_3rdquartile( 0 ), m_stddev( 0 ), m_iterations( 0 )
+    m_max( 0 ), m_1stquartile( 0 ), m_3rdquartile( 0 ), m_stddev( 0 ), m_iterations( 0 ),
+    m_mean_diff( 0 ), m_mean_diff_error( 0 ), m_paired_iterations( 0 )
   { }
 
   profile_result_t( scale_metric_e m ) : m_metric( m ), m_mean( 0 ), m_median( 0 ), m_min( 0 ),
-    m_max( 0 ), m_1stquartile( 0 ), m_3rdquartile( 0 ), m_stddev( 0 ), m_iterations( 0 )
+    m_max( 0 ), m_1stquartile( 0 ), m_3rdquartile( 0 ), m_stddev( 0 ), m_iterations( 0 ),
+    m_mean_diff( 0 ), m_mean_diff_error( 0 ), m_paired_iterations( 0 )
   { }
 
   scale_metric_e metric() const
@@ -110,6 +119,24 @@ public:
   profile_result_t& iterations( size_t i )
   { m_iterations = i; return *this; }
 
+  double mean_diff() const
+  { return m_mean_diff; }
+
+  profile_result_t& mean_diff( double v )
+  { m_mean_diff = v; return *this; }
+
+  double mean_diff_error() const
+  { return m_mean_diff_error; }
+
+  profile_result_t& mean_diff_error( double v )
+  { m_mean_diff_error = v; return *this; }
+
+  size_t paired_iterations() const
+  { return m_paired_iterations; }
+
+  profile_result_t& paired_iterations( size_t i )
+  { m_paired_iterations = i; return *this; }
+
   statistical_data_t statistical_data() const
   { return { m_min, m_1stquartile, m_median, m_mean, m_3rdquartile, m_max, m_stddev }; }
 };
@@ -365,10 +392,12 @@ class profile_set_t
   sim_control_t*                         m_options;
   bool                                   m_has_output;
   std::vector<profile_result_t>          m_results;
+  std::unique_ptr<sim_t>                 m_sim;
+  size_t                                 m_eliminated_iterations;
   std::unique_ptr<profile_output_data_t> m_output_data;
 
 public:
-  profile_set_t( const std::string& name, sim_control_t* opts, bool has_output );
+  profile_set_t( const std::string& name, sim_control_t* opts, bool has_output, sim_t* sim );
 
   ~profile_set_t();
 
@@ -379,9 +408,22 @@ public:
 
   sim_control_t* options() const;
 
+  // Initialized simulator for the profileset, caller is responsible for deleting it
+  sim_t* release_sim();
+
   bool has_output() const
   { return m_has_output; }
 
+  // Dropped from contention by adaptive racing, after the given number of iterations
+  bool eliminated() const
+  { return m_eliminated_iterations > 0; }
+
+  size_t eliminated_iterations() const
+  { return m_eliminated_iterations; }
+
+  void eliminate( size_t iterations )
+  { m_eliminated_iterations = iterations; }
+
   const profile_result_t& result( scale_metric_e metric = SCALE_METRIC_NONE ) const;
 
   profile_result_t& result( scale_metric_e metric );
@@ -453,11 +495,20 @@ class profilesets_t
   std::unique_ptr<sim_control_t>         m_original;
   int64_t                                m_insert_index;
   size_t                                 m_work_index;
+  // Iteration count of the current adaptive racing round, 0 for the full iteration count
+  int                                    m_race_iterations;
+  // Baseline settings inherited by every profileset sim, captured before the init threads start
+  std::shared_ptr<const sim_parent_settings_t> m_parent_settings;
 #ifndef SC_NO_THREADING
   std::mutex                             m_mutex;
   std::unique_lock<std::mutex>           m_control_lock;
   std::condition_variable                m_control;
   std::vector<std::thread>               m_thread;
+
+  // Bounds the number of initialized profileset sims waiting for simulation
+  std::condition_variable                m_prepared;
+  size_t                                 m_preparing;
+  size_t                                 m_max_prepared;
 #endif
 
   // Shared iterator for threaded init workers
@@ -477,6 +528,10 @@ class profilesets_t
   // Parallel profileset stats collection
   double                                 m_start_time;
   double                                 m_total_elapsed;
+
+  // Memory accounting, guarded by m_mutex
+  size_t                                 m_options_memory;
+  size_t                                 m_peak_memory;
 #endif
 
   bool validate( sim_t* sim );
@@ -495,17 +550,22 @@ class profilesets_t
   void cleanup_work();
   void finalize_work();
 
+  void race( sim_t* );
+  size_t eliminate( sim_t* );
+
   sim_control_t* create_sim_options( const sim_control_t*, const std::vector<std::string>& opts );
 public:
   profilesets_t() : m_state( STARTED ), m_mode( SEQUENTIAL ),
     m_original( nullptr ), m_insert_index( -1 ),
-    m_work_index( 0 )
+    m_work_index( 0 ), m_race_iterations( 0 )
 #ifndef SC_NO_THREADING
     ,
     m_control_lock( m_mutex, std::defer_lock ),
+    m_preparing( 0 ), m_max_prepared( 1 ),
     m_max_workers( 0 ), 
     m_work_lock( m_work_mutex, std::defer_lock ),
-    m_start_time( 0 ), m_total_elapsed( 0 )
+    m_start_time( 0 ), m_total_elapsed( 0 ),
+    m_options_memory( 0 ), m_peak_memory( 0 )
 #endif
   { }
 
@@ -533,6 +593,21 @@ public:
 
   std::string current_profileset_name();
 
+  int race_iterations() const
+  { return m_race_iterations; }
+
+  const std::shared_ptr<const sim_parent_settings_t>& parent_settings() const
+  { return m_parent_settings; }
+
+  // Memory held by the option sets of the profilesets
+  size_t memory_usage() const;
+  // Estimated peak memory of the option sets and the profileset sims alive at the same time
+  size_t peak_memory_usage() const;
+  // Profileset sim finished, account for its memory usage
+  void record_memory( const sim_t& profile_sim );
+  // Release the option set of a profileset once it is no longer needed
+  void release_options( profile_set_t& set );
+
   bool parse( sim_t* );
   void initialize( sim_t* );
   void cancel();
@@ -562,6 +637,7 @@ void create_options( sim_t* sim );
 
 statistical_data_t collect( const extended_sample_data_t& c );
 statistical_data_t metric_data( const player_t* player, scale_metric_e metric );
+running_sample_data_t paired_difference( const player_t* baseline, const player_t* player, scale_metric_e metric );
 void save_output_data( profile_set_t& profileset, const player_t* parent_player, const player_t* player, std::string option );
 void fetch_output_data( const profile_output_data_t output_data, js::JsonOutput& ovr );
 
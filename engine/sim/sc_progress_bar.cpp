@@ -68,7 +68,7 @@ void progress_bar_t::init()
   else
   {
     interval = sim.work_queue -> size();
-    if ( sim.deterministic || sim.strict_work_queue )
+    if ( sim.strict_work_queue )
     {
       interval *= sim.threads;
     }
@@ -340,6 +340,19 @@ void progress_bar_t::output( bool finished )
   s << compute_total_phases();
   s << delim;
   s << status;
+
+  const progress_bar_t* root = this;
+  while ( root -> sim.parent )
+  {
+    root = &( root -> sim.parent -> progress_bar );
+  }
+
+  if ( root -> output_callback )
+  {
+    root -> output_callback( s.str() );
+    return;
+  }
+
   s << terminator;
 
   std::cout << s.str() << std::flush;
@@ -70,6 +70,197 @@ bool parse_normalize_scale_factors( sim_t* sim,
   return true;
 }
 
+// paired_difference ========================================================
+
+// Per-iteration differences of a metric between the delta and reference player, over the
+// iterations both sims simulated with the same random stream (deterministic sims only)
+running_sample_data_t paired_difference( const player_t* ref_p, const player_t* delta_p,
+                                         const scaling_metric_data_t& ref, const scaling_metric_data_t& delta )
+{
+  if ( ! ref.data || ! delta.data )
+  {
+    return running_sample_data_t();
+  }
+
+  return ::paired_difference( ref_p -> collected_data.iteration_stream, ref.data -> data(),
+                              delta_p -> collected_data.iteration_stream, delta.data -> data() );
+}
+
+// is_regression_stat =======================================================
+
+// Stats that player_t::stat_gain / stat_loss can perturb during an iteration
+bool is_regression_stat( stat_e stat )
+{
+  switch ( stat )
+  {
+    case STAT_STRENGTH:
+    case STAT_AGILITY:
+    case STAT_STAMINA:
+    case STAT_INTELLECT:
+    case STAT_SPIRIT:
+    case STAT_SPELL_POWER:
+    case STAT_ATTACK_POWER:
+    case STAT_CRIT_RATING:
+    case STAT_HASTE_RATING:
+    case STAT_MASTERY_RATING:
+    case STAT_VERSATILITY_RATING:
+    case STAT_ARMOR:
+    case STAT_BONUS_ARMOR:
+    case STAT_DODGE_RATING:
+    case STAT_PARRY_RATING:
+    case STAT_BLOCK_RATING:
+    case STAT_LEECH_RATING:
+    case STAT_AVOIDANCE_RATING:
+    case STAT_SPEED_RATING:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// scaling_samples ==========================================================
+
+// Per-iteration samples of a scaling metric, empty if the metric does not keep them
+std::vector<double> scaling_samples( const player_t* p, scale_metric_e sm )
+{
+  auto data = p -> scaling_for_metric( sm );
+  if ( data.data )
+  {
+    return data.data -> data();
+  }
+
+  if ( data.metric == SCALE_METRIC_HAPS )
+  {
+    auto hps = p -> scaling_for_metric( SCALE_METRIC_HPS );
+    auto aps = p -> scaling_for_metric( SCALE_METRIC_APS );
+    if ( hps.data && aps.data && hps.data -> data().size() == aps.data -> data().size() )
+    {
+      auto samples = hps.data -> data();
+      for ( size_t i = 0; i < samples.size(); ++i )
+      {
+        samples[ i ] += aps.data -> data()[ i ];
+      }
+      return samples;
+    }
+  }
+
+  return std::vector<double>();
+}
+
+// least_squares ============================================================
+
+// Ordinary least squares fit of y = b0 + sum( b_j * x_j ), with x given as n rows of k values.
+// Returns false if the fit is underdetermined, otherwise the k slopes and their standard errors.
+bool least_squares( const std::vector<double>& x, const std::vector<double>& y, size_t k,
+                    std::vector<double>& slope, std::vector<double>& slope_error )
+{
+  size_t n = y.size(), m = k + 1;
+  if ( x.size() != n * k || n <= m )
+  {
+    return false;
+  }
+
+  // Center y, the intercept absorbs the mean and the normal equations stay well conditioned
+  double y_mean = std::accumulate( y.begin(), y.end(), 0.0 ) / n;
+
+  // Normal equations A * b = r, where A = X'X and r = X'y, with a leading column of ones in X
+  std::vector<double> a( m * m ), r( m );
+  double yy = 0;
+  for ( size_t i = 0; i < n; ++i )
+  {
+    const double* row = &x[ i * k ];
+    double yi = y[ i ] - y_mean;
+    yy += yi * yi;
+    for ( size_t j = 0; j < m; ++j )
+    {
+      double xj = j == 0 ? 1.0 : row[ j - 1 ];
+      r[ j ] += xj * yi;
+      for ( size_t l = 0; l < m; ++l )
+      {
+        a[ j * m + l ] += xj * ( l == 0 ? 1.0 : row[ l - 1 ] );
+      }
+    }
+  }
+
+  // Invert A with Gauss-Jordan elimination
+  std::vector<double> inv( m * m );
+  for ( size_t j = 0; j < m; ++j )
+  {
+    inv[ j * m + j ] = 1.0;
+  }
+
+  for ( size_t c = 0; c < m; ++c )
+  {
+    size_t pivot = c;
+    for ( size_t j = c + 1; j < m; ++j )
+    {
+      if ( std::fabs( a[ j * m + c ] ) > std::fabs( a[ pivot * m + c ] ) )
+      {
+        pivot = j;
+      }
+    }
+
+    if ( a[ pivot * m + c ] == 0 )
+    {
+      return false;
+    }
+
+    for ( size_t l = 0; l < m; ++l )
+    {
+      std::swap( a[ c * m + l ], a[ pivot * m + l ] );
+      std::swap( inv[ c * m + l ], inv[ pivot * m + l ] );
+    }
+
+    double d = a[ c * m + c ];
+    for ( size_t l = 0; l < m; ++l )
+    {
+      a[ c * m + l ] /= d;
+      inv[ c * m + l ] /= d;
+    }
+
+    for ( size_t j = 0; j < m; ++j )
+    {
+      double f = a[ j * m + c ];
+      if ( j == c || f == 0 )
+      {
+        continue;
+      }
+
+      for ( size_t l = 0; l < m; ++l )
+      {
+        a[ j * m + l ] -= f * a[ c * m + l ];
+        inv[ j * m + l ] -= f * inv[ c * m + l ];
+      }
+    }
+  }
+
+  std::vector<double> b( m );
+  for ( size_t j = 0; j < m; ++j )
+  {
+    for ( size_t l = 0; l < m; ++l )
+    {
+      b[ j ] += inv[ j * m + l ] * r[ l ];
+    }
+  }
+
+  // Residual variance from the sums, RSS = y'y - b'X'y
+  double rss = yy;
+  for ( size_t j = 0; j < m; ++j )
+  {
+    rss -= b[ j ] * r[ j ];
+  }
+  double variance = std::max( 0.0, rss ) / ( n - m );
+
+  slope.assign( b.begin() + 1, b.end() );
+  slope_error.resize( k );
+  for ( size_t j = 0; j < k; ++j )
+  {
+    slope_error[ j ] = std::sqrt( variance * inv[ ( j + 1 ) * m + j + 1 ] );
+  }
+
+  return true;
+}
+
 struct compare_scale_factors
 {
   player_t* player;
@@ -121,6 +312,9 @@ scaling_t::scaling_t( sim_t* s ) :
   center_scale_delta( 0 ),
   positive_scale_delta( 0 ),
   scale_lag( 0 ),
+  scale_work_threads( 0 ),
+  scale_crn( 0 ),
+  scale_regression( 0 ),
   scale_factor_noise( 0.10 ),
   normalize_scale_factors( 0 ),
   debug_scale_factors( 0 ),
@@ -230,6 +424,34 @@ void scaling_t::analyze_stats()
   baseline_sim = sim; // Take the current sim as baseline
   mutex.unlock();
 
+  if ( scale_regression )
+  {
+    // Stats that stat gains can perturb are estimated together in one regression sim, the others
+    // keep their delta sims
+    std::vector<stat_e> regression;
+    range::copy_if( stats_to_scale, std::back_inserter( regression ), is_regression_stat );
+    stats_to_scale.erase( std::remove_if( stats_to_scale.begin(), stats_to_scale.end(), is_regression_stat ),
+                          stats_to_scale.end() );
+
+    if ( ! regression.empty() )
+    {
+      analyze_regression( regression );
+    }
+
+    if ( stats_to_scale.empty() )
+    {
+      baseline_sim = nullptr;
+      return;
+    }
+  }
+
+  if ( scale_work_threads > 0 && sim -> threads / scale_work_threads > 1 )
+  {
+    analyze_stats_concurrently( stats_to_scale );
+    baseline_sim = nullptr;
+    return;
+  }
+
   for ( size_t k = 0; k < stats_to_scale.size(); ++k )
   {
     if ( sim -> is_canceled() ) break;
@@ -266,86 +488,326 @@ void scaling_t::analyze_stats()
       ref_sim -> execute();
     }
 
-    for ( size_t j = 0; j < sim -> players_by_name.size(); j++ )
+    analyze_stat( stat, scale_delta, center, ref_sim, delta_sim );
+
+    if ( debug_scale_factors )
+    {
+      std::cout << "\nref_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
+      report::print_text( ref_sim, true );
+      std::cout << "\ndelta_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
+      report::print_text( delta_sim, true );
+    }
+
+    mutex.lock();
+    if ( ref_sim != baseline_sim && ref_sim != sim )
+    {
+      delete ref_sim;
+      ref_sim = nullptr;
+    }
+    delete delta_sim;  
+    delta_sim  = nullptr;
+    remaining_scaling_stats--;
+    mutex.unlock();
+  }
+
+  if ( baseline_sim != sim ) delete baseline_sim;
+  baseline_sim = nullptr;
+}
+
+// scaling_t::analyze_stats_concurrently ====================================
+
+void scaling_t::analyze_stats_concurrently( const std::vector<stat_e>& stats_to_scale )
+{
+  // Reference and delta sims of each stat
+  struct stat_sims_t
+  {
+    stat_e stat;
+    double scale_delta;
+    bool center;
+    sim_t* ref;
+    sim_t* delta;
+  };
+
+  mutex.lock();
+  current_scaling_stat = stats_to_scale.front();
+  mutex.unlock();
+
+  std::vector<stat_sims_t> work;
+  std::vector<std::pair<size_t, bool>> jobs; // ( work index, reference sim )
+  for ( auto stat : stats_to_scale )
+  {
+    double scale_delta = stats.get_stat( stat );
+    assert ( scale_delta );
+
+    bool center = center_scale_delta && ! stat_may_cap( stat );
+
+    work.push_back( { stat, scale_delta, center, center ? nullptr : baseline_sim, nullptr } );
+    jobs.push_back( { work.size() - 1, false } );
+    if ( center )
+    {
+      jobs.push_back( { work.size() - 1, true } );
+    }
+  }
+
+  // Run the sims on a shared thread budget, each sim using scale_work_threads threads
+  // Failures are recorded and the parent canceled once every worker is joined, the other sims may
+  // still read parent state until then
+  std::atomic<size_t> next_job( 0 ), done_jobs( 0 );
+  std::atomic<bool> failed( false );
+  std::vector<std::string> errors;
+  auto run_jobs = [ & ]() {
+    while ( ! sim -> is_canceled() && ! failed )
     {
-      player_t* p = sim -> players_by_name[ j ];
+      auto idx = next_job++;
+      if ( idx >= jobs.size() )
+      {
+        break;
+      }
 
-      if ( ! p -> scaling -> scales_with[ stat ] ) continue;
+      auto& w = work[ jobs[ idx ].first ];
+      auto is_ref = jobs[ idx ].second;
+      std::string base = is_ref ? std::string( "Ref " ) + util::stat_type_abbrev( w.stat ) : util::stat_type_abbrev( w.stat );
 
-      player_t*   ref_p =   ref_sim -> find_player( p -> name() );
-      player_t* delta_p = delta_sim -> find_player( p -> name() );
-      assert( ref_p && "Reference Player not found" );
-      assert( delta_p && "Delta player not found" );
+      try
+      {
+        auto s = new sim_t( sim );
+        s -> threads = scale_work_threads;
+        // Concurrent sims cannot share the progress bar, report finished sims instead
+        s -> report_progress = false;
+        s -> progress_bar.set_base( base );
+        s -> scaling -> scale_stat = w.stat;
+        if ( is_ref )
+        {
+          s -> scaling -> scale_value = -( w.scale_delta / 2 );
+        }
+        else
+        {
+          s -> scaling -> scale_value = +w.scale_delta / ( w.center ? 2 : 1 );
+        }
+
+        ( is_ref ? w.ref : w.delta ) = s;
+        s -> execute();
+      }
+      catch ( const std::exception& e )
+      {
+        mutex.lock();
+        errors.push_back( fmt::format( "Error in scale factor sim '{}': {}", base, e.what() ) );
+        mutex.unlock();
+        failed = true;
+      }
+
+      mutex.lock();
+      if ( sim -> report_progress )
+      {
+        util::fprintf( stdout, "Scale factors (%d*%d): %d/%d sims done\r",
+            sim -> threads / scale_work_threads, scale_work_threads,
+            as<int>( ++done_jobs ), as<int>( jobs.size() ) );
+        fflush( stdout );
+      }
+      mutex.unlock();
+    }
+  };
 
-      double divisor = scale_delta;
+  std::vector<std::thread> threads;
+  for ( int i = 0, end = std::min( sim -> threads / scale_work_threads, as<int>( jobs.size() ) ); i < end; ++i )
+  {
+    threads.push_back( std::thread( run_jobs ) );
+  }
 
-      if ( delta_p -> invert_scaling )
-        divisor = -divisor;
+  range::for_each( threads, []( std::thread& t ) { t.join(); } );
 
-      if ( divisor < 0.0 ) divisor += ref_p -> scaling -> over_cap[ stat ];
+  if ( failed )
+  {
+    range::for_each( errors, [ this ]( const std::string& error ) { sim -> error( "{}", error ); } );
+    sim -> cancel();
+  }
 
-      for ( scale_metric_e sm = SCALE_METRIC_NONE; sm < SCALE_METRIC_MAX; sm++ )
+  for ( auto& w : work )
+  {
+    if ( ! sim -> is_canceled() && w.ref && w.delta )
+    {
+      // Progress reporting reads the current stat under the mutex
+      mutex.lock();
+      current_scaling_stat = w.stat;
+      mutex.unlock();
+
+      analyze_stat( w.stat, w.scale_delta, w.center, w.ref, w.delta );
+
+      if ( debug_scale_factors )
       {
+        std::cout << "\nref_sim report for '" << util::stat_type_string( w.stat ) << "'..." << std::endl;
+        report::print_text( w.ref, true );
+        std::cout << "\ndelta_sim report for '" << util::stat_type_string( w.stat ) << "'..." << std::endl;
+        report::print_text( w.delta, true );
+      }
+    }
+
+    if ( w.ref != baseline_sim )
+    {
+      delete w.ref;
+    }
+    delete w.delta;
+
+    mutex.lock();
+    remaining_scaling_stats--;
+    mutex.unlock();
+  }
+}
 
-        double delta_score = delta_p -> scaling_for_metric( sm ).value;
-        double   ref_score = ref_p -> scaling_for_metric( sm ).value;
+// scaling_t::analyze_regression ============================================
 
-        double delta_error = delta_p -> scaling_for_metric( sm ).stddev * delta_sim -> confidence_estimator;
-        double   ref_error = ref_p -> scaling_for_metric( sm ).stddev * ref_sim -> confidence_estimator;
+void scaling_t::analyze_regression( const std::vector<stat_e>& regression )
+{
+  if ( sim -> is_canceled() ) return;
+
+  mutex.lock();
+  current_scaling_stat = regression.front();
+  ref_sim = baseline_sim;
+  delta_sim = new sim_t( sim );
+  mutex.unlock();
 
-        // TODO: this is the only place in the entire code base where scaling_delta_dps shows up, 
-        // apart from declaration in simulationcraft.hpp line 4535. Possible to remove?
-        p -> scaling -> scaling_delta_dps[ sm ].set_stat( stat, delta_score );
+  delta_sim -> progress_bar.set_base( "Regression" );
+  delta_sim -> scaling -> regression_stats = regression;
+  delta_sim -> scaling -> stats = stats;
+  delta_sim -> execute();
 
-        double score = ( delta_score - ref_score ) / divisor;
-        double error = delta_error * delta_error + ref_error * ref_error;
+  for ( size_t j = 0; j < sim -> players_by_name.size() && ! sim -> is_canceled(); j++ )
+  {
+    player_t* p = sim -> players_by_name[ j ];
+    player_t* delta_p = delta_sim -> find_player( p -> name() );
+    assert( delta_p && "Regression player not found" );
 
-        if ( error > 0 )
-          error = sqrt( error );
+    const auto& offsets = delta_p -> collected_data.scale_offsets;
 
-        error = fabs( error / divisor );
+    for ( scale_metric_e sm = SCALE_METRIC_NONE; sm < SCALE_METRIC_MAX; sm++ )
+    {
+      // Metrics without per-iteration samples have no scale factors
+      auto samples = scaling_samples( delta_p, sm );
+      if ( samples.empty() )
+      {
+        continue;
+      }
 
-        if ( fabs( divisor ) < 1.0 ) // For things like Weapon Speed, show the gain per 0.1 speed gain rather than every 1.0.
+      std::vector<double> slope, slope_error;
+      if ( ! least_squares( offsets, samples, regression.size(), slope, slope_error ) )
+      {
+        if ( offsets.size() != samples.size() * regression.size() )
         {
-          score /= 10.0;
-          error /= 10.0;
-          delta_error /= 10.0;
+          sim -> error( "Player {} regression scale factors for {}: {} stat offsets do not match {} samples of {} stats.",
+                        p -> name(), util::scale_metric_type_abbrev( sm ), offsets.size(),
+                        samples.size(), regression.size() );
         }
+        else
+        {
+          sim -> error( "Player {} regression scale factors for {}: stat offsets of {} iterations do not determine {} stats.",
+                        p -> name(), util::scale_metric_type_abbrev( sm ), samples.size(), regression.size() );
+        }
+        sim -> cancel();
+        continue;
+      }
 
-        analyze_ability_stats( stat, divisor, p, ref_p, delta_p );
+      for ( size_t k = 0; k < regression.size(); ++k )
+      {
+        stat_e stat = regression[ k ];
+        if ( ! p -> scaling -> scales_with[ stat ] ) continue;
 
-        if ( center )
-          p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, error );
-        else
-          p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, delta_error / divisor );
+        double score = delta_p -> invert_scaling ? -slope[ k ] : slope[ k ];
+        double error = slope_error[ k ] * delta_sim -> confidence_estimator;
+
+        if ( std::fabs( stats.get_stat( stat ) ) < 1.0 ) // Same as delta sims, gain per 0.1 instead of every 1.0
+        {
+          score /= 10.0;
+          error /= 10.0;
+        }
 
         p -> scaling -> scaling[ sm ].set_stat( stat, score );
         p -> scaling -> scaling_error[ sm ].set_stat( stat, error );
+        p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, error );
       }
     }
+  }
 
-    if ( debug_scale_factors )
-    {
-      std::cout << "\nref_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
-      report::print_text( ref_sim, true );
-      std::cout << "\ndelta_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
-      report::print_text( delta_sim, true );
-    }
+  if ( debug_scale_factors )
+  {
+    std::cout << "\nregression sim report..." << std::endl;
+    report::print_text( delta_sim, true );
+  }
 
-    mutex.lock();
-    if ( ref_sim != baseline_sim && ref_sim != sim )
+  mutex.lock();
+  delete delta_sim;
+  delta_sim = nullptr;
+  ref_sim = nullptr;
+  remaining_scaling_stats -= as<int>( regression.size() );
+  mutex.unlock();
+}
+
+// scaling_t::analyze_stat ==================================================
+
+void scaling_t::analyze_stat( stat_e stat, double scale_delta, bool center, sim_t* ref, sim_t* delta )
+{
+  for ( size_t j = 0; j < sim -> players_by_name.size(); j++ )
+  {
+    player_t* p = sim -> players_by_name[ j ];
+
+    if ( ! p -> scaling -> scales_with[ stat ] ) continue;
+
+    player_t*   ref_p =   ref -> find_player( p -> name() );
+    player_t* delta_p = delta -> find_player( p -> name() );
+    assert( ref_p && "Reference Player not found" );
+    assert( delta_p && "Delta player not found" );
+
+    double divisor = scale_delta;
+
+    if ( delta_p -> invert_scaling )
+      divisor = -divisor;
+
+    if ( divisor < 0.0 ) divisor += ref_p -> scaling -> over_cap[ stat ];
+
+    for ( scale_metric_e sm = SCALE_METRIC_NONE; sm < SCALE_METRIC_MAX; sm++ )
     {
-      delete ref_sim;
-      ref_sim = nullptr;
+
+      double delta_score = delta_p -> scaling_for_metric( sm ).value;
+      double   ref_score = ref_p -> scaling_for_metric( sm ).value;
+
+      double delta_error = delta_p -> scaling_for_metric( sm ).stddev * delta -> confidence_estimator;
+      double   ref_error = ref_p -> scaling_for_metric( sm ).stddev * ref -> confidence_estimator;
+
+      // TODO: this is the only place in the entire code base where scaling_delta_dps shows up, 
+      // apart from declaration in simulationcraft.hpp line 4535. Possible to remove?
+      p -> scaling -> scaling_delta_dps[ sm ].set_stat( stat, delta_score );
+
+      double score = ( delta_score - ref_score ) / divisor;
+      double error = delta_error * delta_error + ref_error * ref_error;
+
+      if ( error > 0 )
+        error = sqrt( error );
+
+      // With common random numbers, the error of the difference follows from the per-iteration
+      // differences, where most of the noise of the two sims cancels out
+      auto paired = paired_difference( ref_p, delta_p, ref_p -> scaling_for_metric( sm ), delta_p -> scaling_for_metric( sm ) );
+      if ( paired.count() > 1 )
+        error = paired.mean_std_dev() * delta -> confidence_estimator;
+
+      error = fabs( error / divisor );
+
+      if ( fabs( divisor ) < 1.0 ) // For things like Weapon Speed, show the gain per 0.1 speed gain rather than every 1.0.
+      {
+        score /= 10.0;
+        error /= 10.0;
+        delta_error /= 10.0;
+      }
+
+      analyze_ability_stats( stat, divisor, p, ref_p, delta_p );
+
+      if ( center )
+        p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, error );
+      else
+        p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, delta_error / divisor );
+
+      p -> scaling -> scaling[ sm ].set_stat( stat, score );
+      p -> scaling -> scaling_error[ sm ].set_stat( stat, error );
     }
-    delete delta_sim;  
-    delta_sim  = nullptr;
-    remaining_scaling_stats--;
-    mutex.unlock();
   }
-
-  if ( baseline_sim != sim ) delete baseline_sim;
-  baseline_sim = nullptr;
 }
 
 /* Creates scale factors for stats_t objects
@@ -517,6 +979,9 @@ void scaling_t::create_options()
   sim->add_option(opt_float("scale_delta_multiplier", scale_delta_multiplier)); // multiplies all default scale deltas
   sim->add_option(opt_bool("positive_scale_delta", positive_scale_delta));
   sim->add_option(opt_bool("scale_lag", scale_lag));
+  sim->add_option(opt_int("scale_work_threads", scale_work_threads, 0, std::numeric_limits<int>::max()));
+  sim->add_option(opt_bool("scale_crn", scale_crn));
+  sim->add_option(opt_bool("scale_regression", scale_regression));
   sim->add_option(opt_float("scale_factor_noise", scale_factor_noise));
   sim->add_option(opt_float("scale_strength", stats.attribute[ATTR_STRENGTH]));
   sim->add_option(opt_float("scale_agility", stats.attribute[ATTR_AGILITY]));
@@ -68,6 +68,22 @@ struct seed_predicate_t
   { return e.seed == seed; }
 };
 
+// parse_sequence_iteration =================================================
+
+bool parse_sequence_iteration( sim_t* sim, const std::string&, const std::string& value )
+{
+  if ( util::str_compare_ci( value, "first" ) )
+    sim -> sequence_iteration = sim_t::SEQUENCE_FIRST;
+  else if ( util::str_compare_ci( value, "last" ) )
+    sim -> sequence_iteration = sim_t::SEQUENCE_LAST;
+  else if ( util::str_compare_ci( value, "none" ) )
+    sim -> sequence_iteration = sim_t::SEQUENCE_NONE;
+  else
+    throw std::invalid_argument( fmt::format( "Unknown sequence_iteration '{}', expected first, last or none.", value ) );
+
+  return true;
+}
+
 // parse_debug_seed =========================================================
 
 bool parse_debug_seed( sim_t* sim, const std::string&, const std::string& value )
@@ -564,6 +580,24 @@ bool parse_fight_style( sim_t*             sim,
   return true;
 }
 
+// parse_event_queue ========================================================
+
+bool parse_event_queue( sim_t*             sim,
+                        const std::string& /*name*/,
+                        const std::string& value )
+{
+  event_queue_e type = util::parse_event_queue_type( value );
+  if ( type == EVENT_QUEUE_MAX )
+  {
+    throw std::invalid_argument( fmt::format( "Unknown event queue '{}', available values: wheel, ladder, radix_heap",
+      value ) );
+  }
+
+  sim->event_mgr.queue_type = type;
+
+  return true;
+}
+
 // parse_override_spell_data ================================================
 
 bool parse_override_spell_data( sim_t*             sim,
@@ -1333,7 +1367,8 @@ sim_t::sim_t() :
   travel_variance( 0 ), default_skill( 1.0 ), reaction_time( timespan_t::from_seconds( 0.5 ) ),
   regen_periodicity( timespan_t::from_seconds( 0.25 ) ),
   ignite_sampling_delta( timespan_t::from_seconds( 0.2 ) ),
-  fixed_time( true ), optimize_expressions( false ),
+  fixed_time( true ), optimize_expressions( false ), compile_expressions( false ),
+  cache_expressions( false ),
   current_slot( -1 ),
   optimal_raid( 0 ), log( 0 ),
   debug_each( 0 ),
@@ -1346,6 +1381,7 @@ sim_t::sim_t() :
   save_talent_str( 0 ),
   talent_format( TALENT_FORMAT_UNCHANGED ),
   stat_cache( 1 ),
+  monitor_stat_cache( false ),
   max_aoe_enemies( 20 ),
   show_etmi( 0 ),
   tmi_window_global( 0 ),
@@ -1360,7 +1396,7 @@ sim_t::sim_t() :
   disable_set_bonuses( false ), disable_2_set( 1 ), disable_4_set( 1 ), enable_2_set( 1 ), enable_4_set( 1 ),
   pvp_crit( false ),
   active_enemies( 0 ), active_allies( 0 ),
-  _rng(), seed( 0 ), deterministic( 0 ), strict_work_queue( 0 ),
+  _rng(), seed( 0 ), stream_key( 0 ), iteration_stream( 0 ), replay_iteration( -1 ), deterministic( 0 ), sequence_iteration( SEQUENCE_FIRST ), strict_work_queue( 0 ), work_stealing( 0 ), work_chunk_size( 0 ),
   average_range( true ), average_gauss( false ),
   fight_style(), add_waves( 0 ), overrides( overrides_t() ),
   default_aura_delay( timespan_t::from_millis( 30 ) ),
@@ -1383,7 +1419,7 @@ sim_t::sim_t() :
   // Report
   report_precision(2), report_pets_separately( 0 ), report_targets( 1 ), report_details( 1 ), report_raw_abilities( 1 ),
   report_rng( 0 ), hosted_html( 0 ),
-  save_raid_summary( 0 ), save_gear_comments( 0 ), statistics_level( 1 ), separate_stats_by_actions( 0 ), report_raid_summary( 0 ), buff_uptime_timeline( 0 ),
+  save_raid_summary( 0 ), save_gear_comments( 0 ), statistics_level( 1 ), statistics_sketch( 0 ), separate_stats_by_actions( 0 ), report_raid_summary( 0 ), buff_uptime_timeline( 0 ),
   json_full_states( 0 ),
   decorated_tooltips( -1 ),
   allow_potions( true ),
@@ -1398,7 +1434,8 @@ sim_t::sim_t() :
   enable_dps_healing( false ),
   scaling_normalized( 1.0 ),
   // Multi-Threading
-  threads( 0 ), thread_index( 0 ), process_priority( computer_process::BELOW_NORMAL ),
+  threads( 0 ), deferred_setup( false ), parent_settings(), child_control(), thread_index( 0 ),
+  process_priority( computer_process::BELOW_NORMAL ),
   work_queue( new work_queue_t() ),
   spell_query(), spell_query_level( MAX_LEVEL ),
   pause_mutex( nullptr ),
@@ -1412,7 +1449,11 @@ sim_t::sim_t() :
   profileset_output_data(),
   profileset_enabled( false ),
   profileset_work_threads( 0 ),
-  profileset_init_threads( 1 )
+  profileset_init_threads( 1 ),
+  profileset_crn( 0 ),
+  profileset_race_top( 0 ),
+  profileset_race_iterations( 100 ),
+  profileset_race_threshold( -100.0 )
 {
   item_db_sources.assign( std::begin( default_item_db_sources ),
                           std::end( default_item_db_sources ) );
@@ -1435,49 +1476,81 @@ sim_t::sim_t( sim_t* p, int index ) : sim_t()
 
   // Inherit setup
   setup( parent -> control );
+  inherit_settings( sim_parent_settings_t( *parent ) );
 
-  // Inherit 'scaling' settings from parent because these are set outside of the config file
-  assert( parent -> scaling );
-  scaling -> scale_stat  = parent -> scaling -> scale_stat;
-  scaling -> scale_value = parent -> scaling -> scale_value;
+  parent -> add_relative( this );
+}
 
-  // Inherit reporting directives from parent
-  report_progress = parent -> report_progress;
+sim_t::sim_t( sim_t* p, int index, sim_control_t* control,
+              std::shared_ptr<const sim_parent_settings_t> settings, bool defer_setup ) : sim_t()
+{
+  assert( p && control && settings );
 
-  // Inherit 'plot' settings from parent because are set outside of the config file
-  enchant = parent -> enchant;
+  parent = p;
+  thread_index = index;
+  parent_settings = std::move( settings );
 
-  // While we inherit the parent seed, it may get overwritten in sim_t::init
-  seed = parent -> seed;
+  // Use specialized control for setup. Deferred setup is performed by the child thread itself
+  // in sim_t::run, so that child sims of a partitioned simulation parse options and create
+  // actors in parallel, instead of sequentially in the main thread. The parent settings are
+  // captured by the caller in the parent's thread, setup never reads the parent sim.
+  if ( defer_setup )
+  {
+    this -> control = control;
+    deferred_setup = true;
+  }
+  else
+  {
+    setup_from_parent( control );
+  }
 
   parent -> add_relative( this );
 }
 
-sim_t::sim_t( sim_t* p, int index, sim_control_t* control ) : sim_t()
+// sim_parent_settings_t::sim_parent_settings_t =============================
+
+sim_parent_settings_t::sim_parent_settings_t( const sim_t& parent ) :
+  scale_stat( parent.scaling -> scale_stat ),
+  scale_value( parent.scaling -> scale_value ),
+  regression_stats( parent.scaling -> regression_stats ),
+  scaling_stats( parent.scaling -> stats ),
+  report_progress( parent.report_progress ),
+  enchant( parent.enchant ),
+  // Deterministic parents replace their seed every iteration, so inherit the one they were
+  // initialized with
+  seed( parent.stream_key ? parent.stream_key : parent.seed )
+{ }
+
+// sim_t::setup_from_parent =================================================
+
+void sim_t::setup_from_parent( sim_control_t* c )
 {
-  assert( p && control );
+  auto start = std::chrono::high_resolution_clock::now();
 
-  parent = p;
-  thread_index = index;
+  setup( c );
+  inherit_settings( *parent_settings );
+
+  init_time += util::duration_fp_seconds( start );
+}
 
-  // Use specialized control for setup
-  setup( control );
+// sim_t::inherit_settings ==================================================
 
+void sim_t::inherit_settings( const sim_parent_settings_t& settings )
+{
   // Inherit 'scaling' settings from parent because these are set outside of the config file
-  assert( parent -> scaling );
-  scaling -> scale_stat  = parent -> scaling -> scale_stat;
-  scaling -> scale_value = parent -> scaling -> scale_value;
+  scaling -> scale_stat  = settings.scale_stat;
+  scaling -> scale_value = settings.scale_value;
+  scaling -> regression_stats = settings.regression_stats;
+  scaling -> stats       = settings.scaling_stats;
 
   // Inherit reporting directives from parent
-  report_progress = parent -> report_progress;
+  report_progress = settings.report_progress;
 
   // Inherit 'plot' settings from parent because are set outside of the config file
-  enchant = parent -> enchant;
+  enchant = settings.enchant;
 
   // While we inherit the parent seed, it may get overwritten in sim_t::init
-  seed = parent -> seed;
-
-  parent -> add_relative( this );
+  seed = settings.seed;
 }
 
 // sim_t::~sim_t ============================================================
@@ -1637,7 +1710,7 @@ void sim_t::reset()
     out_debug << "Resetting Simulator";
 
   if( deterministic )
-    seed = rng().reseed();
+    seed = rng().seed_stream( stream_key, iteration_stream );
 
   event_mgr.reset();
 
@@ -1909,12 +1982,11 @@ void sim_t::datacollection_end()
   total_absorb.add( iteration_absorb );
   raid_aps.add( current_time() != timespan_t::zero() ? iteration_absorb / current_time().total_seconds() : 0 );
 
-  if ( deterministic && report_iteration_data > 0 && current_iteration > 0 &&
-       current_time() > timespan_t::zero() )
+  if ( deterministic && report_iteration_data > 0 && current_time() > timespan_t::zero() )
   {
     // TODO: Metric should be selectable
     iteration_data_entry_t entry( iteration_dmg / current_time().total_seconds(),
-        current_time().total_seconds(), seed, current_iteration );
+        current_time().total_seconds(), seed, iteration_stream );
     for ( size_t i = 0, end = target_list.size(); i < end; ++i )
     {
       const player_t* t = target_list[ i ];
@@ -1972,19 +2044,17 @@ void sim_t::analyze_error()
 
   current_error = 0;
 
+  // The running statistics of each thread combine in O(threads), instead of analyzing all samples
   if ( single_actor_batch )
   {
     auto p = player_no_pet_list[ current_index ];
-    auto& cd = p -> collected_data;
-    AUTO_LOCK( cd.target_metric_mutex );
-    if ( cd.target_metric.size() != 0 )
+    auto data = p -> collected_data.target_metric_running();
+    if ( data.count() != 0 )
     {
-      cd.target_metric.analyze_basics();
-      cd.target_metric.analyze_variance();
-      current_mean = cd.target_metric.mean();
+      current_mean = data.mean();
       if ( current_mean != 0 )
       {
-        current_error = sim_t::distribution_mean_error( *this, cd.target_metric ) / current_mean;
+        current_error = confidence_estimator * data.mean_std_dev() / current_mean;
       }
     }
   }
@@ -1993,16 +2063,13 @@ void sim_t::analyze_error()
     for ( size_t i = 0; i < actor_list.size(); i++ )
     {
       player_t* p = actor_list[i];
-      player_collected_data_t& cd = p -> collected_data;
-      AUTO_LOCK( cd.target_metric_mutex );
-      if ( cd.target_metric.size() != 0 )
+      auto data = p -> collected_data.target_metric_running();
+      if ( data.count() != 0 )
       {
-        cd.target_metric.analyze_basics();
-        cd.target_metric.analyze_variance();
-        double mean = cd.target_metric.mean();
+        double mean = data.mean();
         if ( mean != 0 )
         {
-          double error = sim_t::distribution_mean_error( *this, cd.target_metric ) / mean;
+          double error = confidence_estimator * data.mean_std_dev() / mean;
           if ( error > current_error ) current_error = error;
           mean_total += mean;
           mean_count++;
@@ -2444,6 +2511,7 @@ void sim_t::init()
       seed  = uint64_t(rd()) | (uint64_t(rd()) << 32);
     }
   }
+  stream_key = seed;
   _rng = rng::create( rng::parse_type( rng_str ) );
   _rng -> seed( seed + thread_index );
 
@@ -2618,7 +2686,7 @@ void sim_t::init()
 
   initialized = true;
 
-  init_time = util::duration_fp_seconds( start );
+  init_time += util::duration_fp_seconds( start );
 
   if (canceled)
   {
@@ -2665,6 +2733,8 @@ void sim_t::analyze()
   analyze_iteration_data();
 
   analyze_time = util::duration_fp_seconds( start );
+
+  sample_memory_usage();
 }
 
 /**
@@ -2723,6 +2793,23 @@ bool sim_t::iterate()
   bool more_work = true;
   do
   {
+    if ( deterministic )
+    {
+      // The iteration number selects the random stream of the iteration, so the data of each
+      // iteration does not depend on which thread simulates it. Aggregate results still vary in
+      // their last bits with the thread count, as threads sum their iterations before merging.
+      // Independent work queues number their own iterations.
+      int n = work_queue -> claim( current_index );
+      if ( n < 0 )
+      {
+        break;
+      }
+
+      iteration_stream = ( uint64_t( current_index ) << 48 ) |
+                         ( strict_work_queue ? uint64_t( thread_index ) << 32 : 0 ) |
+                         uint64_t( n + std::max( 0, replay_iteration ) );
+    }
+
     ++current_iteration;
     ++work_done;
 
@@ -2735,7 +2822,11 @@ bool sim_t::iterate()
 
     do_pause();
     auto old_active = current_index;
-    if ( ! canceled )
+    if ( ! canceled && work_queue -> stealing() )
+    {
+      more_work = work_queue -> steal_pop( thread_index );
+    }
+    else if ( ! canceled )
     {
       current_index = work_queue -> pop();
       more_work = work_queue -> more_work();
@@ -2775,7 +2866,8 @@ bool sim_t::iterate()
 
   iterations = current_iteration + 1;
 
-  return iterations > 0;
+  // Deterministic sims may find all iterations claimed by other threads before their first one
+  return iterations > 0 || deterministic;
 }
 
 /**
@@ -2809,17 +2901,25 @@ void sim_t::merge( sim_t& other_sim )
   auto_lock_t auto_lock( merge_mutex );
   auto start = std::chrono::high_resolution_clock::now();
 
-  if ( scaling -> scale_stat == STAT_NONE &&
-       scaling -> calculate_scale_factors == 0 &&
-       plot -> dps_plot_stat_str.empty() &&
-       reforge_plot -> reforge_plot_stat_str.empty() &&
-       profileset_map.size() == 0 && ! profileset_enabled )
+  // Child sims merge their subtree of the merge tree too, output settings live in the main thread
+  sim_t& root = parent ? *parent : *this;
+  if ( root.scaling -> scale_stat == STAT_NONE &&
+       root.scaling -> calculate_scale_factors == 0 &&
+       root.plot -> dps_plot_stat_str.empty() &&
+       root.reforge_plot -> reforge_plot_stat_str.empty() &&
+       root.profileset_map.size() == 0 && ! root.profileset_enabled )
   {
+    AUTO_LOCK( root.output_mutex );
     std::cout << "Merging data from thread-" << other_sim.thread_index << " ..." << std::endl;
   }
 
   iterations += other_sim.iterations;
-  work_per_thread[ other_sim.thread_index ] = other_sim.work_done;
+  // Per-thread entries are disjoint, the other sim carries the entries of its whole subtree
+  for ( size_t i = 0; i < work_per_thread.size() && i < other_sim.work_per_thread.size(); ++i )
+  {
+    work_per_thread[ i ] += other_sim.work_per_thread[ i ];
+    init_time_per_thread[ i ] += other_sim.init_time_per_thread[ i ];
+  }
 
   simulation_length.merge( other_sim.simulation_length );
   total_dmg.merge( other_sim.total_dmg );
@@ -2838,6 +2938,7 @@ void sim_t::merge( sim_t& other_sim )
     }
   }
 
+  std::vector<std::pair<player_t*, player_t*>> merge_players;
   for ( auto & player : actor_list )
   {
     // If the player is spawned by a separate wrapper class, it will handle the merging process
@@ -2848,9 +2949,11 @@ void sim_t::merge( sim_t& other_sim )
 
     player_t* other_p = other_sim.find_player( player -> index );
     assert( other_p );
-    player -> merge( *other_p );
+    merge_players.push_back( std::make_pair( player, other_p ) );
   }
 
+  merge_actors( merge_players );
+
   // After normal player merging, merge all dynamically spawned players. This is done after the
   // normal player merging because the dynamic spawner merging process may need to create new actors
   // into the parent (e.g., thread 0) sim to accommodate child sims managing to create more actors
@@ -2862,31 +2965,204 @@ void sim_t::merge( sim_t& other_sim )
   init_time += other_sim.init_time;
 }
 
+/// merge actor pairs, actors are independent of each other so the main thread spreads them over threads
+void sim_t::merge_actors( const std::vector<std::pair<player_t*, player_t*>>& merge_players )
+{
+  auto merge_pair = []( const std::pair<player_t*, player_t*>& pair ) {
+    pair.first -> merge( *pair.second );
+  };
+
+#ifndef SC_NO_THREADING
+  // Child sims merging their subtree of the merge tree already run concurrently
+  size_t n_workers = parent ? 1 : std::min( static_cast<size_t>( threads ), merge_players.size() );
+  if ( n_workers > 1 )
+  {
+    std::atomic<size_t> next( 0 );
+    auto worker = [ &next, &merge_players, &merge_pair ]() {
+      for ( size_t i = next++; i < merge_players.size(); i = next++ )
+      {
+        merge_pair( merge_players[ i ] );
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for ( size_t i = 1; i < n_workers; ++i )
+    {
+      workers.emplace_back( worker );
+    }
+    worker();
+
+    range::for_each( workers, []( std::thread& t ) { t.join(); } );
+    return;
+  }
+#endif
+
+  range::for_each( merge_players, merge_pair );
+}
+
+/**
+ * Pairwise (binomial tree) reduction of the thread results. At step k, every thread whose index is
+ * a multiple of 2^(k+1) joins the thread 2^k above it and merges it, so no thread performs more than
+ * log2( threads ) merges, and merges of disjoint pairs run concurrently.
+ */
+void sim_t::merge_tree()
+{
+  sim_t* root = parent ? parent : this;
+  int n_threads = as<int>( root -> children.size() ) + 1;
+
+  for ( int step = 1; thread_index % ( 2 * step ) == 0 && thread_index + step < n_threads; step *= 2 )
+  {
+    sim_t* other = root -> children[ thread_index + step - 1 ];
+    other -> join();
+
+    // A failed child sim has no results to merge, it cancels the whole simulation anyhow
+    if ( ( ! parent || initialized ) && other -> initialized )
+    {
+      merge( *other );
+    }
+  }
+}
+
 /// merge all sims together
 void sim_t::merge()
 {
   work_per_thread[ thread_index ] = work_done;
+  init_time_per_thread[ thread_index ] = init_time;
 
   if ( children.empty() )
+  {
+    sample_memory_usage();
     return;
+  }
 
   merge_mutex.unlock();
 
+  // Child threads reduce their subtrees in parallel, every child has finished once the direct
+  // partners of the main thread are merged
+  merge_tree();
+
+  // Both the merged results and the data of the thread sims are alive at this point
+  sample_memory_usage();
+
   for ( size_t i = 0; i < children.size(); i++ )
   {
     sim_t* child = children[ i ];
-    if ( child )
+    children[ i ] = nullptr;
+    if ( requires_cleanup() )
     {
-      child -> join();
-      children[ i ] = nullptr;
-      if ( requires_cleanup() )
-      {
-        delete child;
-      }
+      delete child;
     }
   }
 
   children.clear();
+  child_control.reset();
+
+  if ( work_queue -> stealing() )
+  {
+    auto& thread_work = work_queue -> thread_work;
+    steals_per_thread.resize( thread_work.size() );
+    idle_per_thread.resize( thread_work.size() );
+
+    // Idle time is the time spent looking for work to steal, plus the time a thread sat finished
+    // while the last thread was still simulating.
+    double last_finish = 0;
+    for ( const auto& tw : thread_work )
+    {
+      last_finish = std::max( last_finish, tw -> finish_time );
+    }
+
+    for ( size_t i = 0; i < thread_work.size(); ++i )
+    {
+      steals_per_thread[ i ] = thread_work[ i ] -> steals;
+      idle_per_thread[ i ] = thread_work[ i ] -> idle_time + last_finish - thread_work[ i ] -> finish_time;
+    }
+  }
+}
+
+// sim_t::memory_usage ======================================================
+
+void sim_t::memory_usage( memory_usage_t::values_t& v ) const
+{
+  for ( const auto actor : actor_list )
+  {
+    actor -> memory_usage( v );
+  }
+
+  for ( const auto buff : buff_list )
+  {
+    v[ memory_usage_t::MEMORY_BUFFS ] += buff -> memory_size();
+    v[ memory_usage_t::MEMORY_TIMELINES ] += buff -> uptime_array.memory_size();
+  }
+
+  v[ memory_usage_t::MEMORY_SAMPLE_DATA ] += simulation_length.memory_size() +
+    ( iteration_data.capacity() + low_iteration_data.capacity() + high_iteration_data.capacity() ) *
+    sizeof( iteration_data_entry_t );
+  v[ memory_usage_t::MEMORY_EVENTS ] += event_mgr.memory_usage();
+}
+
+// sim_t::sample_memory_usage ===============================================
+
+void sim_t::sample_memory_usage()
+{
+  memory_usage_t::values_t v {};
+  memory_usage( v );
+
+  for ( const auto child : children )
+  {
+    if ( child )
+    {
+      memory_usage_t::values_t child_v {};
+      child -> memory_usage( child_v );
+      v[ memory_usage_t::MEMORY_THREAD_SIMS ] += memory_usage_t::total( child_v );
+    }
+  }
+
+  v[ memory_usage_t::MEMORY_PROFILESETS ] = profilesets.memory_usage();
+
+  memory.sample( v );
+
+  // Profileset sims are simulated on top of the final state of this sim
+  size_t profileset_peak = profilesets.peak_memory_usage();
+  auto& peak = memory.peak[ memory_usage_t::MEMORY_PROFILESETS ];
+  peak = std::max( peak, profileset_peak );
+  memory.peak_total = std::max( memory.peak_total, memory.total() - v[ memory_usage_t::MEMORY_PROFILESETS ] + profileset_peak );
+}
+
+// memory_usage_t::sample ===================================================
+
+void memory_usage_t::sample( const values_t& v )
+{
+  current = v;
+  for ( size_t i = 0; i < v.size(); ++i )
+  {
+    peak[ i ] = std::max( peak[ i ], v[ i ] );
+  }
+  peak_total = std::max( peak_total, total( v ) );
+}
+
+// memory_usage_t::total ====================================================
+
+size_t memory_usage_t::total( const values_t& v )
+{
+  return std::accumulate( v.begin(), v.end(), size_t( 0 ) );
+}
+
+// memory_usage_t::category_string ==========================================
+
+const char* memory_usage_t::category_string( category_e c )
+{
+  switch ( c )
+  {
+    case MEMORY_SAMPLE_DATA:     return "Sample Data";
+    case MEMORY_TIMELINES:       return "Timelines";
+    case MEMORY_ACTION_SEQUENCE: return "Action Sequence";
+    case MEMORY_EVENTS:          return "Events";
+    case MEMORY_ACTION_STATES:   return "Action States";
+    case MEMORY_BUFFS:           return "Buffs";
+    case MEMORY_THREAD_SIMS:     return "Thread Sims";
+    case MEMORY_PROFILESETS:     return "Profilesets";
+    default:                     return "Unknown";
+  }
 }
 
 // sim_t::run ===============================================================
@@ -2895,9 +3171,22 @@ void sim_t::run()
 {
   try
   {
+    if ( deferred_setup )
+    {
+      // Setup re-parses the full configuration, keep the iterations assigned by the parent in
+      // sim_t::partition
+      auto assigned_iterations = iterations;
+
+      setup_from_parent( control );
+
+      iterations = assigned_iterations;
+      report_progress = 0;
+    }
+
     if( iterate() )
     {
-      parent -> merge( *this );
+      work_per_thread[ thread_index ] = work_done;
+      init_time_per_thread[ thread_index ] = init_time;
     }
   }
   catch (const std::exception& e )
@@ -2906,6 +3195,135 @@ void sim_t::run()
       parent -> error("Error in child simulation ({}): {}", thread_index, e.what());
     cancel();
   }
+
+  // Threads below this one in the merge tree have to be joined even if this thread failed
+  try
+  {
+    merge_tree();
+  }
+  catch (const std::exception& e )
+  {
+    if (parent)
+      parent -> error("Error merging child simulation ({}): {}", thread_index, e.what());
+    cancel();
+  }
+}
+
+// sim_t::work_queue_t::init_stealing ======================================
+
+void sim_t::work_queue_t::init_stealing( int threads, int chunk_size )
+{
+  G l( m );
+
+  int work = _total_work.front();
+
+  // Every thread needs at least one chunk, since it starts its first iteration before popping work
+  chunk_size = std::max( 1, std::min( chunk_size, work / threads ) );
+
+  thread_work.clear();
+  for ( int i = 0; i < threads; ++i )
+  {
+    thread_work.emplace_back( new thread_work_t() );
+  }
+
+  size_t thread = 0;
+  for ( int remaining = work; remaining > 0; remaining -= chunk_size )
+  {
+    thread_work[ thread ] -> chunks.push_back( std::min( chunk_size, remaining ) );
+    thread = ( thread + 1 ) % thread_work.size();
+  }
+
+  for ( auto& tw : thread_work )
+  {
+    tw -> current = tw -> chunks.back() - 1;
+    tw -> chunks.pop_back();
+  }
+
+  stealing_work = 0;
+  stealing_projected = _projected_work.front();
+  stealing_flushed = false;
+  start_time = std::chrono::high_resolution_clock::now();
+}
+
+// sim_t::work_queue_t::steal_pop ==========================================
+
+bool sim_t::work_queue_t::steal_pop( int thread )
+{
+  ++stealing_work;
+
+  thread_work_t& own = *thread_work[ thread ];
+  {
+    AUTO_LOCK( own.m );
+    if ( own.current > 0 )
+    {
+      own.current--;
+      return true;
+    }
+
+    if ( ! own.chunks.empty() )
+    {
+      own.current = own.chunks.back() - 1;
+      own.chunks.pop_back();
+      return true;
+    }
+  }
+
+  // Out of local work, steal the oldest chunk of a peer, or half of the chunk it is simulating
+  auto start = std::chrono::high_resolution_clock::now();
+  int stolen = 0;
+  for ( size_t i = 1; i < thread_work.size() && stolen == 0; ++i )
+  {
+    thread_work_t& peer = *thread_work[ ( thread + i ) % thread_work.size() ];
+    AUTO_LOCK( peer.m );
+    if ( ! peer.chunks.empty() )
+    {
+      stolen = peer.chunks.front();
+      peer.chunks.pop_front();
+    }
+    else if ( peer.current > 1 )
+    {
+      stolen = peer.current / 2;
+      peer.current -= stolen;
+    }
+  }
+
+  AUTO_LOCK( own.m );
+  own.idle_time += util::duration_fp_seconds( start );
+  // The queue may have been flushed between taking the chunk from the peer and here
+  if ( stolen == 0 || stealing_flushed )
+  {
+    own.finish_time = util::duration_fp_seconds( start_time );
+    return false;
+  }
+
+  own.steals++;
+  own.current = stolen - 1;
+  return true;
+}
+
+// sim_t::work_queue_t::flush_stealing =====================================
+
+void sim_t::work_queue_t::flush_stealing()
+{
+  // Hold every deque for the whole flush, otherwise other threads keep stealing from the deques
+  // that are not cleared yet. Stealing threads hold at most one deque at a time, so taking them
+  // all in order cannot deadlock.
+  for ( auto& tw : thread_work )
+  {
+    tw -> m.lock();
+  }
+
+  for ( auto& tw : thread_work )
+  {
+    tw -> chunks.clear();
+    tw -> current = 0;
+  }
+  stealing_flushed = true;
+
+  for ( auto& tw : thread_work )
+  {
+    tw -> m.unlock();
+  }
 }
 
 // sim_t::partition =========================================================
@@ -2930,29 +3348,35 @@ void sim_t::partition()
   // However, when we desire deterministic runs (for debugging) we need to force the
   // sims to each use a specific number of iterations as opposed to using shared pool of work.
 
-  if ( deterministic || strict_work_queue )
+  if ( strict_work_queue )
   {
     work_queue -> init( iterations );
   }
+  else if ( work_stealing )
+  {
+    // Default to eight chunks per thread, enough for stealing to even out the tail of the run
+    int chunk_size = work_chunk_size > 0 ? work_chunk_size : std::max( 1, iterations / 8 );
+    work_queue -> init_stealing( threads, chunk_size );
+  }
 
   int num_children = threads - 1;
 
-  sim_control_t* child_control = nullptr;
+  sim_control_t* setup_control = control;
   // Filter out profileset-related options from the child sim control, since they are not going to
   // use them anyhow. This significantly speeds up child creation in situations where the input
   // profile is a very large set of profileset sims.
   if ( profileset_map.size() > 0 )
   {
-    child_control = profileset::filter_control( control );
-  }
-  else
-  {
-    child_control = control;
+    child_control.reset( profileset::filter_control( control ) );
+    setup_control = child_control.get();
   }
 
+  // Children set themselves up in their own threads, while this sim starts iterating
+  auto settings = std::make_shared<const sim_parent_settings_t>( *this );
+
   for ( int i = 0; i < num_children; i++ )
   {
-    auto  child = new sim_t( this, i + 1, child_control );
+    auto  child = new sim_t( this, i + 1, setup_control, settings, true );
 
     assert( child );
     children.push_back( child );
@@ -2964,8 +3388,12 @@ void sim_t::partition()
       remainder--;
     }
 
-    if( deterministic || strict_work_queue )
+    if( strict_work_queue )
     {
+      if ( single_actor_batch )
+      {
+        child -> work_queue -> batches( player_no_pet_list.size() );
+      }
       child -> work_queue -> init( child -> iterations );
     }
     else // share the work queue
@@ -2979,13 +3407,6 @@ void sim_t::partition()
 
   for ( auto & child : children )
     child -> launch();
-
-  // Safe to do for now, since control is only referenced by sim_t::setup, which is called in the
-  // sim_t constructor.
-  if ( profileset_map.size() > 0 )
-  {
-    delete child_control;
-  }
 }
 
 // sim_t::execute ===========================================================
@@ -3290,8 +3711,11 @@ void sim_t::create_options()
   add_option( opt_func( "item_db_source", parse_item_sources ) );
   add_option( opt_func( "proxy", parse_proxy ) );
   add_option( opt_int( "stat_cache", stat_cache ) );
+  add_option( opt_bool( "monitor_stat_cache", monitor_stat_cache ) );
   add_option( opt_int( "max_aoe_enemies", max_aoe_enemies ) );
   add_option( opt_bool( "optimize_expressions", optimize_expressions ) );
+  add_option( opt_bool( "compile_expressions", compile_expressions ) );
+  add_option( opt_bool( "cache_expressions", cache_expressions ) );
   add_option( opt_bool( "single_actor_batch", single_actor_batch ) );
   add_option( opt_bool( "progressbar_type", progressbar_type ) );
   // Raid buff overrides
@@ -3355,7 +3779,11 @@ void sim_t::create_options()
   // RNG
   add_option( opt_string( "rng", rng_str ) );
   add_option( opt_bool( "deterministic", deterministic ) );
+  add_option( opt_int( "replay_iteration", replay_iteration ) );
+  add_option( opt_func( "sequence_iteration", parse_sequence_iteration ) );
   add_option( opt_bool( "strict_work_queue", strict_work_queue ) );
+  add_option( opt_bool( "work_stealing", work_stealing ) );
+  add_option( opt_int( "work_chunk_size", work_chunk_size ) );
   add_option( opt_float( "report_iteration_data", report_iteration_data ) );
   add_option( opt_int( "min_report_iteration_data", min_report_iteration_data ) );
   add_option( opt_bool( "average_range", average_range ) );
@@ -3367,6 +3795,7 @@ void sim_t::create_options()
   add_option( opt_float( "wheel_granularity", event_mgr.wheel_granularity ) );
   add_option( opt_int( "wheel_seconds", event_mgr.wheel_seconds ) );
   add_option( opt_int( "wheel_shift", event_mgr.wheel_shift ) );
+  add_option( opt_func( "event_queue", parse_event_queue ) );
   add_option( opt_string( "reference_player", reference_player_str ) );
   add_option( opt_string( "raid_events", raid_events_str ) );
   add_option( opt_append( "raid_events+", raid_events_str ) );
@@ -3450,10 +3879,12 @@ void sim_t::create_options()
   add_option( opt_bool( "report_raw_abilities", report_raw_abilities ) );
   add_option( opt_bool( "report_rng", report_rng ) );
   add_option( opt_int( "statistics_level", statistics_level ) );
+  add_option( opt_float( "statistics_sketch", statistics_sketch ) );
   add_option( opt_bool( "separate_stats_by_actions", separate_stats_by_actions ) );
   add_option( opt_bool( "report_raid_summary", report_raid_summary ) ); // Force reporting of raid summary
   add_option( opt_string( "reforge_plot_output_file", reforge_plot_output_file_str ) );
   add_option( opt_bool( "monitor_cpu", event_mgr.monitor_cpu ) );
+  add_option( opt_bool( "profile_events", event_mgr.profile_events ) );
   add_option( opt_func( "maximize_reporting", parse_maximize_reporting ) );
   add_option( opt_string( "apikey", apikey ) );
   add_option( opt_bool( "distance_targeting_enabled", distance_targeting_enabled ) );
@@ -3645,6 +4076,14 @@ void sim_t::setup( sim_control_t* c )
     threads = 1;
   }
 
+  // Replaying a single iteration of a deterministic sim re-simulates its random stream
+  if ( replay_iteration >= 0 )
+  {
+    deterministic = 1;
+    iterations = 1;
+    threads = 1;
+  }
+
   if ( iterations <= 0 )
   {
     iterations = 1000000; // limited by relative standard error
@@ -3676,20 +4115,60 @@ void sim_t::setup( sim_control_t* c )
     }
   }
 
-  if ( single_actor_batch )
+  // Deferred child sims run on the work queue set up for them in sim_t::partition
+  if ( ! deferred_setup )
   {
-    work_queue -> batches( player_no_pet_list.size() );
+    if ( single_actor_batch )
+    {
+      work_queue -> batches( player_no_pet_list.size() );
+    }
+    work_queue -> init( iterations );
   }
-  work_queue -> init( iterations );
-  if ( thread_index == 0 )
+  // Child sims collect the per-thread data of their subtree of the merge tree
+  work_per_thread.resize( parent ? parent -> threads : threads );
+  init_time_per_thread.resize( work_per_thread.size() );
+
+  // Common random numbers need the same per-iteration random streams in every simulation
+  if ( profileset_crn || scaling -> scale_crn )
   {
-    work_per_thread.resize( threads );
+    if ( target_error != 0 )
+    {
+      throw std::invalid_argument("profileset_crn=1 or scale_crn=1 cannot be used with non-zero target_error values!");
+    }
+
+    deterministic = 1;
   }
 
   if( deterministic && ( target_error != 0 ) )
   {
     throw std::invalid_argument("deterministic=1 cannot be used with non-zero target_error values!");
   }
+
+  // Deterministic sims share the work queue through per-iteration random streams, except with
+  // per-actor work batches, where threads can move on to the next actor before all iterations of
+  // the current one are claimed.
+  if ( deterministic && single_actor_batch )
+  {
+    strict_work_queue = 1;
+  }
+
+  // Strict work queues number iterations per thread, and the thread is part of the random stream
+  if ( replay_iteration >= 0 && strict_work_queue )
+  {
+    throw std::invalid_argument("replay_iteration cannot be used with strict_work_queue=1 or single_actor_batch=1!");
+  }
+
+  // Work stealing hands iterations to whichever thread is idle, which cannot be combined with
+  // per-iteration random streams (deterministic runs) or per-actor work batches. It replaces the
+  // strict work queue split otherwise.
+  if ( work_stealing && ( deterministic || single_actor_batch ) )
+  {
+    work_stealing = 0;
+  }
+  if ( work_stealing )
+  {
+    strict_work_queue = 0;
+  }
 }
 
 // sim_t::progress ==========================================================
@@ -3706,7 +4185,7 @@ sim_progress_t sim_t::progress( std::string* detailed, int index )
   }
 
   // For work queues that are independent, collect all work done so far for the progressbar.
-  if ( deterministic || strict_work_queue )
+  if ( strict_work_queue )
   {
     AUTO_LOCK( relatives_mutex );
     for ( const auto& child : children )
@@ -3834,6 +4313,10 @@ std::vector<double> sc_timeline_t::build_divisor_timeline( const extended_sample
   size_t max_buckets = static_cast<size_t>( floor( simulation_length.max() / bin_size ) + 1);
   divisor_timeline.assign( max_buckets, 0.0 );
 
+  // Count the iterations ending in each bucket, every bucket up to the end of an iteration is
+  // then visited by the iterations ending in or after it.
+  std::vector<double> ends( max_buckets, 0.0 );
+
   size_t num_timelines = simulation_length.data().size();
   for ( size_t i = 0; i < num_timelines; i++ )
   {
@@ -3844,17 +4327,14 @@ std::vector<double> sc_timeline_t::build_divisor_timeline( const extended_sample
     if ( use_old_behaviour )
     {
       // Add all visited buckets.
-      for ( size_t j = 0; j <= last; j++ )
-      {
-        divisor_timeline[ j ] += 1.0;
-      }
+      ends[ last ] += 1.0;
     }
     else
     {
       // First add fully visited buckets.
-      for ( size_t j = 0; j < last; j++ )
+      if ( last > 0 )
       {
-        divisor_timeline[ j ] += 1.0;
+        ends[ last - 1 ] += 1.0;
       }
 
       // Now add partial amount for the last incomplete bucket.
@@ -3867,6 +4347,13 @@ std::vector<double> sc_timeline_t::build_divisor_timeline( const extended_sample
     }
   }
 
+  double visits = 0.0;
+  for ( size_t j = max_buckets; j-- > 0; )
+  {
+    visits += ends[ j ];
+    divisor_timeline[ j ] += visits;
+  }
+
   return divisor_timeline;
 }
 
@@ -46,11 +46,13 @@
 #include <vector>
 #include <bitset>
 #include <array>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <atomic>
+#include <chrono>
 #include <random>
 #if defined( SC_OSX )
 #include <Availability.h>
@@ -80,6 +82,7 @@ struct cost_reduction_buff_t;
 class dbc_t;
 struct dot_t;
 struct event_t;
+struct event_slab_t;
 struct expr_t;
 struct gain_t;
 struct heal_t;
@@ -139,6 +142,9 @@ namespace highchart {
 // Timeline
 #include "util/timeline.hpp"
 
+// Name lookup
+#include "util/name_index.hpp"
+
 // Random Number Generators
 #include "util/rng.hpp"
 
@@ -681,6 +687,22 @@ struct sim_control_t
   option_db_t options;
 };
 
+// Settings a sim set up from a parent sim inherits, because they are set outside of the
+// configuration file. They are captured once in the parent's thread, so that sims set up in other
+// threads never read the parent while it initializes or runs.
+struct sim_parent_settings_t
+{
+  stat_e scale_stat;
+  double scale_value;
+  std::vector<stat_e> regression_stats;
+  gear_stats_t scaling_stats;
+  int report_progress;
+  gear_stats_t enchant;
+  uint64_t seed;
+
+  explicit sim_parent_settings_t( const sim_t& parent );
+};
+
 struct sim_progress_t
 {
   int current_iterations;
@@ -701,6 +723,9 @@ struct progress_bar_t
   size_t work_index, total_work_;
   double elapsed_time;
   size_t time_count;
+  // Receives progress lines ( without line terminator ) of this and all child sims instead of
+  // standard output, if set
+  std::function<void( const std::string& )> output_callback;
 
   progress_bar_t( sim_t& s );
   void init();
@@ -890,6 +915,136 @@ private:
 #define ACTOR_EVENT_BOOKKEEPING 0
 #endif
 
+// Event Profile ============================================================
+
+// Count and wall clock time spent per event type, action execute / tick and buff trigger /
+// expire, collected with profile_events=1. Times include nested work, e.g. the execute of an
+// action is also part of the time of the event that executed it.
+struct event_profile_t
+{
+  enum category_e
+  {
+    PROFILE_EVENT,
+    PROFILE_ACTION_EXECUTE,
+    PROFILE_ACTION_TICK,
+    PROFILE_BUFF_TRIGGER,
+    PROFILE_BUFF_EXPIRE,
+    PROFILE_MAX
+  };
+
+  using clock_type = std::chrono::steady_clock;
+
+  struct entry_t
+  {
+    std::string name;
+    uint64_t count = 0;
+    uint64_t nanoseconds = 0;
+  };
+
+  // Profiles the lifetime of the scope, does nothing without a profile
+  class scope_t
+  {
+    event_profile_t* profile;
+    category_e category;
+    const player_t* actor;
+    const char* name;
+    clock_type::time_point start;
+
+  public:
+    scope_t( event_profile_t* p, category_e c, const player_t* a, const char* n ) :
+      profile( p ), category( c ), actor( a ), name( n )
+    {
+      if ( profile )
+        start = clock_type::now();
+    }
+
+    ~scope_t()
+    {
+      if ( profile )
+        profile -> add( category, actor, name, clock_type::now() - start );
+    }
+  };
+
+  void add( category_e c, const player_t* actor, const char* name, clock_type::duration elapsed )
+  {
+    auto& sample = samples[ c ][ sample_key_t{ actor, name } ];
+    sample.count++;
+    sample.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count();
+  }
+
+  void merge( const event_profile_t& other );
+  // Entries of a category by name, in descending order of time
+  std::vector<entry_t> entries( category_e c ) const;
+  uint64_t total_nanoseconds( category_e c ) const;
+  static const char* category_string( category_e c );
+
+private:
+  struct sample_t
+  {
+    uint64_t count = 0;
+    uint64_t nanoseconds = 0;
+  };
+
+  // Samples are keyed by the name pointer (and owner) while simulating, names are only built
+  // when the profile is merged or reported
+  struct sample_key_t
+  {
+    const player_t* actor;
+    const char* name;
+
+    bool operator==( const sample_key_t& other ) const
+    { return actor == other.actor && name == other.name; }
+  };
+
+  struct key_hash_t
+  {
+    size_t operator()( const sample_key_t& k ) const
+    { return std::hash<const void*>()( k.actor ) * 31 + std::hash<const void*>()( k.name ); }
+  };
+
+  std::array<std::unordered_map<sample_key_t, sample_t, key_hash_t>, PROFILE_MAX> samples;
+  // Merged samples of other threads, by name
+  std::array<std::map<std::string, sample_t>, PROFILE_MAX> merged;
+
+  static std::string sample_name( const sample_key_t& k );
+  void collect( category_e c, std::map<std::string, sample_t>& out ) const;
+};
+
+// Memory Usage =============================================================
+
+// Heap memory attributed to simulator subsystems, in bytes. Sizes are taken from container
+// capacities and allocator counters whenever the simulator samples them (after the thread sims
+// have been merged, after analysis and after profilesets), peak values are the largest samples.
+struct memory_usage_t
+{
+  enum category_e
+  {
+    MEMORY_SAMPLE_DATA,      // Sample data of actors and stats
+    MEMORY_TIMELINES,
+    MEMORY_ACTION_SEQUENCE,
+    MEMORY_EVENTS,           // Event allocator arenas and queue
+    MEMORY_ACTION_STATES,    // Lower bound, counted at the size of action_state_t
+    MEMORY_BUFFS,
+    MEMORY_THREAD_SIMS,      // Everything held by the child sims of the other threads
+    MEMORY_PROFILESETS,      // Profileset option sets and simulators
+    MEMORY_MAX
+  };
+
+  using values_t = std::array<size_t, MEMORY_MAX>;
+
+  values_t current, peak;
+  size_t peak_total;
+
+  memory_usage_t() : current(), peak(), peak_total( 0 )
+  { }
+
+  void sample( const values_t& v );
+  size_t total() const
+  { return total( current ); }
+  static size_t total( const values_t& v );
+  static const char* category_string( category_e c );
+};
+
 // Event Manager ============================================================
 
 struct event_manager_t
@@ -901,15 +1056,32 @@ struct event_manager_t
   uint64_t total_events_processed;
   uint64_t max_events_remaining;
   unsigned timing_slice, global_event_id;
+  event_queue_e queue_type;
   std::vector<event_t*> timing_wheel;
-  event_t* recycled_event_list;
+  // Per-slice list tails for the ladder queue, so out-of-slice inserts are O(1) appends
+  std::vector<event_t*> timing_wheel_tail;
+  // Radix heap buckets, bucket i holds events whose key differs from radix_last in bit i - 1
+  std::array<event_t*, 65> radix_bucket;
+  uint64_t radix_last;
   int    wheel_seconds, wheel_size, wheel_mask, wheel_shift;
   double wheel_granularity;
   timespan_t wheel_time;
-  std::vector<event_t*> allocated_events;
+
+  // Slab allocator. Events are served from cache line aligned blocks of
+  // EVENT_MIN_BLOCK_SIZE << n bytes, carved out of EVENT_SLAB_SIZE aligned slabs.
+  static const unsigned EVENT_SIZE_CLASSES = 6;
+  static const std::size_t EVENT_MIN_BLOCK_SIZE = 64;
+  static const std::size_t EVENT_SLAB_SIZE = 16384;
+  std::array<event_t*, EVENT_SIZE_CLASSES> recycled_event_list;
+  std::vector<event_slab_t*> event_slabs, spare_event_slabs;
+  std::vector<void*> event_arenas;
+  std::array<uint64_t, EVENT_SIZE_CLASSES> n_class_requests;
+  std::array<unsigned, EVENT_SIZE_CLASSES> n_class_slabs;
 
   stopwatch_t event_stopwatch;
   bool monitor_cpu;
+  bool profile_events;
+  std::unique_ptr<event_profile_t> profile;
   bool canceled;
 #ifdef EVENT_QUEUE_DEBUG
   unsigned max_queue_depth, n_allocated_events, n_end_insert, n_requested_events;
@@ -922,9 +1094,16 @@ struct event_manager_t
  ~event_manager_t();
   void* allocate_event( std::size_t size );
   void recycle_event( event_t* );
+  event_slab_t* allocate_slab( unsigned size_class );
+  size_t memory_usage() const;
+  static std::size_t event_block_size( unsigned size_class )
+  { return EVENT_MIN_BLOCK_SIZE << size_class; }
   void add_event( event_t*, timespan_t delta_time );
   void reschedule_event( event_t* );
   event_t* next_event();
+  event_t* next_radix_event();
+  const char* queue_type_str() const
+  { return util::event_queue_type_string( queue_type ); }
   bool execute();
   void cancel();
   void flush();
@@ -991,7 +1170,7 @@ struct sim_t : private sc_thread_t
   double      travel_variance, default_skill;
   timespan_t  reaction_time, regen_periodicity;
   timespan_t  ignite_sampling_delta;
-  bool        fixed_time, optimize_expressions;
+  bool        fixed_time, optimize_expressions, compile_expressions, cache_expressions;
   int         current_slot;
   int         optimal_raid, log, debug_each;
   std::vector<uint64_t> debug_seed;
@@ -1005,6 +1184,7 @@ struct sim_t : private sc_thread_t
   auto_dispose< std::vector<player_t*> > actor_list;
   std::string main_target_str;
   int         stat_cache;
+  bool        monitor_stat_cache;
   int         max_aoe_enemies;
   bool        show_etmi;
   double      tmi_window_global;
@@ -1056,8 +1236,15 @@ struct sim_t : private sc_thread_t
   std::unique_ptr<rng::rng_t> _rng;
   std::string rng_str;
   uint64_t seed;
+  // Deterministic sims simulate iteration N with random stream N of the stream key
+  uint64_t stream_key, iteration_stream;
+  int replay_iteration;
   int deterministic;
+  // Iteration recorded into the sample action sequence of the main thread
+  enum sequence_iteration_e { SEQUENCE_NONE, SEQUENCE_FIRST, SEQUENCE_LAST } sequence_iteration;
   int strict_work_queue;
+  int work_stealing;
+  int work_chunk_size;
   int average_range, average_gauss;
 
   // Raid Events
@@ -1129,6 +1316,7 @@ struct sim_t : private sc_thread_t
 
   // Auras and De-Buffs
   auto_dispose<std::vector<buff_t*>> buff_list;
+  mutable name_index_t<buff_t> buff_index;
 
   // Global aura related delay
   timespan_t default_aura_delay;
@@ -1147,11 +1335,15 @@ struct sim_t : private sc_thread_t
   double elapsed_cpu;
   double elapsed_time;
   std::vector<size_t> work_per_thread;
+  std::vector<unsigned> steals_per_thread;
+  std::vector<double> idle_per_thread;
+  std::vector<double> init_time_per_thread;
   size_t work_done;
   double     iteration_dmg, priority_iteration_dmg,  iteration_heal, iteration_absorb;
   simple_sample_data_t raid_dps, total_dmg, raid_hps, total_heal, total_absorb, raid_aps;
   extended_sample_data_t simulation_length;
   double merge_time, init_time, analyze_time;
+  memory_usage_t memory;
   // Deterministic simulation iteration data collectors for specific iteration
   // replayability
   std::vector<iteration_data_entry_t> iteration_data, low_iteration_data, high_iteration_data;
@@ -1188,6 +1380,7 @@ struct sim_t : private sc_thread_t
   int save_raid_summary;
   int save_gear_comments;
   int statistics_level;
+  double statistics_sketch; // Quantile sketch compression for collected data, 0 to store every sample
   int separate_stats_by_actions;
   int report_raid_summary;
   int buff_uptime_timeline;
@@ -1208,8 +1401,14 @@ struct sim_t : private sc_thread_t
 
   // Multi-Threading
   mutex_t merge_mutex;
+  // Serializes console output and error_list updates, actors are merged concurrently
+  mutex_t output_mutex;
   int threads;
   std::vector<sim_t*> children; // Manual delete!
+  // Child threads parse their options and create their actors in their own thread
+  bool deferred_setup;
+  std::shared_ptr<const sim_parent_settings_t> parent_settings;
+  std::unique_ptr<sim_control_t> child_control;
   int thread_index;
   computer_process::priority_e process_priority;
   struct work_queue_t
@@ -1230,26 +1429,59 @@ struct sim_t : private sc_thread_t
     using G = nop;
 #endif
     public:
-    std::vector<int> _total_work, _work, _projected_work;
+    std::vector<int> _total_work, _work, _projected_work, _claimed;
     size_t index;
 
-    work_queue_t() : index( 0 )
-    { _total_work.resize( 1 ); _work.resize( 1 ); _projected_work.resize( 1 ); }
+    // Work stealing state. Iterations are split into chunks spread over one deque per thread.
+    // Threads take chunks from the back of their own deque, and steal from the front of their
+    // peers' deques once it runs dry, so the iteration path only takes an uncontended per-thread
+    // lock.
+    struct thread_work_t
+    {
+      mutex_t m;
+      std::deque<int> chunks;
+      int current; // Iterations left in the chunk being simulated
+      unsigned steals;
+      double idle_time, finish_time;
+      thread_work_t() : current( 0 ), steals( 0 ), idle_time( 0 ), finish_time( 0 ) {}
+    };
+    std::vector<std::unique_ptr<thread_work_t>> thread_work;
+    std::atomic<int> stealing_work, stealing_projected;
+    // Set by flush_stealing while it holds every deque, work stolen before the flush is dropped
+    bool stealing_flushed;
+    std::chrono::high_resolution_clock::time_point start_time;
+
+    work_queue_t() : index( 0 ), stealing_work( 0 ), stealing_projected( 0 ), stealing_flushed( false )
+    { _total_work.resize( 1 ); _work.resize( 1 ); _projected_work.resize( 1 ); _claimed.resize( 1 ); }
 
-    void init( int w )    { G l(m); range::fill( _total_work, w ); range::fill( _projected_work, w ); }
+    void init( int w )    { G l(m); range::fill( _total_work, w ); range::fill( _projected_work, w ); range::fill( _claimed, 0 ); }
     // Single actor batch sim init methods. Batches is the number of active actors
-    void batches( size_t n ) { G l(m); _total_work.resize( n ); _work.resize( n ); _projected_work.resize( n ); }
+    void batches( size_t n ) { G l(m); _total_work.resize( n ); _work.resize( n ); _projected_work.resize( n ); _claimed.resize( n ); }
 
-    void flush()          { G l(m); _total_work[ index ] = _projected_work[ index ] = _work[ index ]; }
+    void flush()          { G l(m); _total_work[ index ] = _projected_work[ index ] = stealing_projected = stealing() ? stealing_work.load() : _work[ index ]; flush_stealing(); }
     int  size()           { G l(m); return index < _total_work.size() ? _total_work[ index ] : _total_work.back(); }
     bool more_work()      { G l(m); return index < _total_work.size() && _work[ index ] < _total_work[ index ]; }
+    bool stealing() const { return ! thread_work.empty(); }
     void lock()           { m.lock(); }
     void unlock()         { m.unlock(); }
 
+    // Hand out the next iteration number of the index, or -1 once all of its work is handed out.
+    // Deterministic sims claim the number before simulating it, since it selects the random stream.
+    int claim( size_t idx )
+    {
+      G l(m);
+      if ( idx >= _total_work.size() || _claimed[ idx ] >= _total_work[ idx ] )
+      {
+        return -1;
+      }
+      return _claimed[ idx ]++;
+    }
+
     void project( int w )
     {
       G l(m);
       _projected_work[ index ] = w;
+      stealing_projected = w;
 #ifdef NDEBUG
       if ( w > _work[ index ] )
       {
@@ -1289,6 +1521,12 @@ struct sim_t : private sc_thread_t
     // sims progress with the main thread's current index.
     sim_progress_t progress( int idx = -1 )
     {
+      // Work stealing progress is tracked with atomics, keep the shared lock off the iteration path
+      if ( stealing() )
+      {
+        return sim_progress_t{ stealing_work.load(), stealing_projected.load() };
+      }
+
       G l(m);
       size_t current_index = idx;
       if ( idx < 0 )
@@ -1303,6 +1541,10 @@ struct sim_t : private sc_thread_t
 
       return sim_progress_t{ _work[ current_index ], _projected_work[ current_index ] };
     }
+
+    void init_stealing( int threads, int chunk_size );
+    bool steal_pop( int thread );
+    void flush_stealing();
   };
   std::shared_ptr<work_queue_t> work_queue;
 
@@ -1344,12 +1586,20 @@ struct sim_t : private sc_thread_t
   std::vector<std::string> profileset_output_data;
   bool profileset_enabled;
   int profileset_work_threads, profileset_init_threads;
+  // Common random numbers: baseline and profilesets simulate iterations with identical random
+  // streams, so profileset results can be compared to the baseline iteration by iteration
+  int profileset_crn;
+  // Adaptive racing: number of top profilesets to find, iterations of the first round, and the
+  // threshold relative to the baseline (in percent) below which profilesets are dropped
+  int profileset_race_top, profileset_race_iterations;
+  double profileset_race_threshold;
   profileset::profilesets_t profilesets;
 
 
   sim_t();
   sim_t( sim_t* parent, int thread_index = 0 );
-  sim_t( sim_t* parent, int thread_index, sim_control_t* control );
+  sim_t( sim_t* parent, int thread_index, sim_control_t* control,
+         std::shared_ptr<const sim_parent_settings_t> settings, bool defer_setup = false );
   virtual ~sim_t();
 
   virtual void run() override;
@@ -1378,6 +1628,10 @@ struct sim_t : private sc_thread_t
   void      analyze();
   void      merge( sim_t& other_sim );
   void      merge();
+  void      merge_tree();
+  void      merge_actors( const std::vector<std::pair<player_t*, player_t*>>& merge_players );
+  void      memory_usage( memory_usage_t::values_t& ) const;
+  void      sample_memory_usage();
   bool      iterate();
   void      partition();
   bool      execute();
@@ -1405,6 +1659,8 @@ struct sim_t : private sc_thread_t
 
     auto s = fmt::sprintf(std::forward<Format>(format), std::forward<Args>(args)... );
     util::replace_all( s, "\n", "" );
+
+    AUTO_LOCK( output_mutex );
     std::cerr << s << "\n";
 
     error_list.push_back( s );
@@ -1421,6 +1677,8 @@ struct sim_t : private sc_thread_t
 
     auto s = fmt::format(std::forward<Format>(format), std::forward<Args>(args)... );
     util::replace_all( s, "\n", "" );
+
+    AUTO_LOCK( output_mutex );
     std::cerr << s << "\n";
 
     error_list.push_back( s );
@@ -1494,6 +1752,8 @@ struct sim_t : private sc_thread_t
 
 private:
   void do_pause();
+  void setup_from_parent( sim_control_t* );
+  void inherit_settings( const sim_parent_settings_t& );
   void print_spell_query();
   void enable_debug_seed();
   void disable_debug_seed();
@@ -1594,6 +1854,14 @@ struct scaling_t
   int    center_scale_delta;
   int    positive_scale_delta;
   int    scale_lag;
+  // Threads of each concurrently run scale factor sim, 0 runs them one after another
+  int    scale_work_threads;
+  // Common random numbers: reference and delta sims simulate identical random streams
+  int    scale_crn;
+  // Estimate scale factors with a single sim, by regression over random per-iteration stat offsets
+  int    scale_regression;
+  // Stats perturbed in each iteration of a regression scale factor sim
+  std::vector<stat_e> regression_stats;
   double scale_factor_noise;
   int    normalize_scale_factors;
   int    debug_scale_factors;
@@ -1612,6 +1880,9 @@ struct scaling_t
   void init_deltas();
   void analyze();
   void analyze_stats();
+  void analyze_stats_concurrently( const std::vector<stat_e>& );
+  void analyze_regression( const std::vector<stat_e>& );
+  void analyze_stat( stat_e, double scale_delta, bool center, sim_t* ref, sim_t* delta );
   void analyze_ability_stats( stat_e, double, player_t*, player_t*, player_t* );
   void analyze_lag();
   void normalize();
@@ -2840,18 +3111,35 @@ private:
  * - Same goes for stat_buff_t, which works through player_t::stat_gain/loss
  * - Buffs with effects in a composite_ function need invalidates added to their buff_creator
  *
- * To create invalidation chains ( eg. Priest: Spirit invalidates Hit ) override the
- * virtual player_t::invalidate_cache( cache_e ) function.
+ * To create invalidation chains ( eg. Priest: Spirit invalidates Hit ) declare a dependency
+ * with player_stat_cache_t::add_dependency in player_t::init_cache_dependencies(). Invalidating
+ * an entry invalidates everything that transitively depends on it in a single bitset operation.
  *
- * Attention: player_t::invalidate_cache( cache_e ) is recursive and may call itself again.
+ * Overriding the virtual player_t::invalidate_cache( cache_e ) function is only needed for
+ * invalidations that depend on the runtime state of the actor, or that have side effects.
+ * Such an override only sees the entry that is invalidated directly, not its dependents, so
+ * entries it reacts to must not be reachable through a dependency. Declare them with
+ * player_stat_cache_t::add_side_effect in init_cache_dependencies(), debug builds assert that no
+ * dependency reaches them.
  */
 struct player_stat_cache_t
 {
+  typedef std::bitset<CACHE_MAX> cache_set_t;
+
   const player_t* player;
-  mutable std::array<bool, CACHE_MAX> valid;
-  mutable std::array < bool, SCHOOL_MAX + 1 > spell_power_valid, player_mult_valid, player_heal_mult_valid;
   // 'valid'-states
+  mutable cache_set_t valid;
+  mutable std::bitset<SCHOOL_MAX + 1> spell_power_valid, player_mult_valid, player_heal_mult_valid;
+  // Instrumentation, counted while monitor is set
+  mutable std::array<uint64_t, CACHE_MAX> hits, recomputes, invalidations;
 private:
+  // Transitive closure of the dependency graph, the entries invalidated along with each entry
+  std::array<cache_set_t, CACHE_MAX> dependents;
+  // Entries the invalidate_cache override of the actor reacts to
+  cache_set_t side_effects;
+
+  bool side_effects_reachable() const;
+
   // cached values
   mutable double _strength, _agility, _stamina, _intellect, _spirit;
   mutable double _spell_power[SCHOOL_MAX + 1], _attack_power;
@@ -2865,12 +3153,31 @@ private:
   mutable double _player_mult[SCHOOL_MAX + 1], _player_heal_mult[SCHOOL_MAX + 1];
   mutable double _damage_versatility, _heal_versatility, _mitigation_versatility;
   mutable double _leech, _run_speed, _avoidance;
+
+  // Check validity of entry c for an access, counting it when monitored
+  bool recompute( cache_e c, bool invalid ) const
+  {
+    bool r = !active || invalid;
+    if ( monitor )
+      ++( r ? recomputes : hits )[ c ];
+    return r;
+  }
 public:
   bool active; // runtime active-flag
+  bool monitor; // count cache hits, recomputes and invalidations
   void invalidate_all();
   void invalidate( cache_e );
+  /// Invalidating c also invalidates dependent, and everything that depends on it
+  void add_dependency( cache_e c, cache_e dependent );
+  /// The invalidate_cache override of the actor has side effects for c
+  void add_side_effect( cache_e c );
+  /// Entries invalidated along with c, including c itself
+  const cache_set_t& invalidation_set( cache_e c ) const
+  { return dependents[ c ]; }
+  void reset_counters();
+  void merge_counters( const player_stat_cache_t& other );
   double get_attribute( attribute_e ) const;
-  player_stat_cache_t( const player_t* p ) : player( p ), active( false ) { invalidate_all(); }
+  player_stat_cache_t( const player_t* p );
 #if defined(SC_USE_STAT_CACHE)
   // Cache stat functions
   double strength() const;
@@ -3000,6 +3307,8 @@ struct player_collected_data_t
   // Metric used to end simulations early
   extended_sample_data_t target_metric;
   mutex_t target_metric_mutex;
+  // Running target metric statistics of each thread, for the convergence check of target_error
+  std::vector<concurrent_running_sample_data_t> target_metric_threads;
 
   std::vector<simple_sample_data_t> resource_lost, resource_gained;
   struct resource_timeline_t
@@ -3028,11 +3337,22 @@ struct player_collected_data_t
   struct health_changes_timeline_t
   {
     double previous_loss_level, previous_gain_level;
-    sc_timeline_t timeline; // keeps only data per iteration
-    sc_timeline_t timeline_normalized; // same as above, but normalized to current player health
+    sc_timeline_t timeline; // keeps only data per iteration, for the TMI debug output
+    sc_timeline_t timeline_normalized; // per iteration, normalized to current player health
     sc_timeline_t merged_timeline;
     bool collect; // whether we collect all this or not.
-    health_changes_timeline_t() : previous_loss_level( 0.0 ), previous_gain_level( 0.0 ), collect( false ) {}
+    bool keep_iteration_timeline; // whether the per iteration timeline is recorded
+    health_changes_timeline_t() : previous_loss_level( 0.0 ), previous_gain_level( 0.0 ), collect( false ),
+      keep_iteration_timeline( false ) {}
+
+    // Health changes accumulate straight into the merged timeline, instead of a per iteration
+    // copy merged at the end of every iteration
+    void add( timespan_t current_time, double amount )
+    {
+      merged_timeline.add( current_time, amount );
+      if ( keep_iteration_timeline )
+        timeline.add( current_time, amount );
+    }
 
     void set_bin_size( double bin )
     {
@@ -3060,11 +3380,19 @@ struct player_collected_data_t
   // used.
   int total_iterations;
 
+  // Random stream of each collected iteration of a deterministic sim, in the order of the
+  // per-iteration samples. Pairs the iterations of simulations that share their random streams.
+  std::vector<uint64_t> iteration_stream;
+
+  // Stat offsets of each collected iteration of a regression scale factor sim, one offset per
+  // regression stat, in the order of the per-iteration samples
+  std::vector<double> scale_offsets;
+
   struct action_sequence_data_t : noncopyable
   {
     const action_t* action;
     const player_t* target;
-    const timespan_t time;
+    timespan_t time;
     timespan_t wait_time;
     std::vector< std::pair< buff_t*, std::vector<double> > > buff_list;
     std::vector< std::pair< cooldown_t*, std::vector<double> > > cooldown_list;
@@ -3074,9 +3402,15 @@ struct player_collected_data_t
 
     action_sequence_data_t( const timespan_t& ts, const timespan_t& wait, const player_t* p );
     action_sequence_data_t( const action_t* a, const player_t* t, const timespan_t& ts, const player_t* p );
+
+    // Take a new snapshot, reusing the memory of the previous one
+    void snapshot( const action_t* a, const player_t* t, const timespan_t& ts, const timespan_t& wait,
+                   const player_t* p );
   };
   std::vector<action_sequence_data_t> action_sequence;
   std::vector<action_sequence_data_t> action_sequence_precombat;
+  // Entries of discarded recordings, reused by the next recorded iteration
+  std::vector<action_sequence_data_t> action_sequence_pool;
 
   // Buffed snapshot_stats (for reporting)
   struct buffed_stats_t
@@ -3095,9 +3429,14 @@ struct player_collected_data_t
 
   player_collected_data_t( const player_t* player );
   void reserve_memory( const player_t& );
+  void enable_sketches( const player_t& );
+  void sequence_restart();
+  void sequence_append( std::vector<action_sequence_data_t>& sequence, const action_t* a, const player_t* t,
+                        const timespan_t& ts, const timespan_t& wait, const player_t* p );
   void merge( const player_t& );
   void analyze( const player_t& );
   void collect_data( const player_t& );
+  running_sample_data_t target_metric_running() const;
   void print_tmi_debug_csv( const sc_timeline_t* nma, const std::vector<double>& weighted_value, const player_t& p );
   double calculate_tmi( const health_changes_timeline_t& tl, int window, double f_length, const player_t& p );
   double calculate_max_spike_damage( const health_changes_timeline_t& tl, int window );
@@ -3312,12 +3651,14 @@ struct scaling_metric_data_t {
   std::string name;
   double value, stddev;
   scale_metric_e metric;
+  // Per-iteration samples of the metric, if it has any
+  const extended_sample_data_t* data;
   scaling_metric_data_t( scale_metric_e m, const std::string& n, double v, double dev ) :
-    name( n ), value( v ), stddev( dev ), metric( m ) {}
+    name( n ), value( v ), stddev( dev ), metric( m ), data( nullptr ) {}
   scaling_metric_data_t( scale_metric_e m, const extended_sample_data_t& sd ) :
-    name( sd.name_str ), value( sd.mean() ), stddev( sd.mean_std_dev ), metric( m ) {}
+    name( sd.name_str ), value( sd.mean() ), stddev( sd.mean_std_dev ), metric( m ), data( &sd ) {}
   scaling_metric_data_t( scale_metric_e m, const sc_timeline_t& tl, const std::string& name ) :
-    name( name ), value( tl.mean() ), stddev( tl.mean_stddev() ), metric( m ) {}
+    name( name ), value( tl.mean() ), stddev( tl.mean_stddev() ), metric( m ), data( nullptr ) {}
 };
 
 struct player_scaling_t
@@ -3331,6 +3672,8 @@ struct player_scaling_t
   std::array<bool, STAT_MAX> scales_with;
   std::array<double, STAT_MAX> over_cap;
   std::array<std::vector<stat_e>, SCALE_METRIC_MAX> scaling_stats; // sorting vector
+  // Stat offsets of the current iteration of a regression scale factor sim
+  std::vector<double> iteration_offsets;
 
   player_scaling_t()
   {
@@ -3611,6 +3954,14 @@ struct player_t : public actor_t
   std::vector<std::vector<plot_data_t> > reforge_plot_data;
   auto_dispose< std::vector<luxurious_sample_data_t*> > sample_data_list;
 
+  // Name indices of the lists above, built lazily by the find functions
+  mutable name_index_t<action_t> action_index;
+  mutable name_index_t<buff_t> buff_index;
+  mutable name_index_t<proc_t> proc_index;
+  mutable name_index_t<gain_t> gain_index;
+  mutable name_index_t<stats_t> stats_index;
+  mutable name_index_t<cooldown_t> cooldown_index;
+
   // All Data collected during / end of combat
   player_collected_data_t collected_data;
 
@@ -4029,6 +4380,7 @@ public:
 
   // Virtual methods
   virtual void invalidate_cache( cache_e c );
+  virtual void init_cache_dependencies();
   virtual void init();
   virtual void override_talent( std::string& override_str );
   virtual void init_meta_gem();
@@ -4074,6 +4426,7 @@ public:
   virtual void combat_begin();
   virtual void combat_end();
   virtual void merge( player_t& other );
+  void memory_usage( memory_usage_t::values_t& ) const;
   virtual void datacollection_begin();
   virtual void datacollection_end();
 
@@ -5224,6 +5577,8 @@ public:
   bool interrupt_global;
 
   expr_t* if_expr;
+  /// if_expr lowered into a flat program, when compile_expressions is set
+  std::unique_ptr<expression::program_t> if_program;
 
   enum target_if_mode_e
   {
@@ -5250,6 +5605,9 @@ public:
   proc_t* starved_proc;
   uint_least64_t total_executions;
 
+  /// Readiness checks that reused or had to evaluate the cached if_program result
+  uint_least64_t if_cache_hits, if_cache_misses;
+
   /**
    * @brief Cooldown for specific APL line.
    *
@@ -5288,6 +5646,8 @@ public:
 private:
   std::vector<std::unique_ptr<option_t>> options;
   action_state_t* state_cache;
+  // Number of states created through new_state(), for memory accounting
+  unsigned allocated_states;
   std::vector<travel_event_t*> travel_events;
 public:
   action_t( action_e type, const std::string& token, player_t* p, const spell_data_t* s = spell_data_t::nil() );
@@ -5724,6 +6084,9 @@ public:
   virtual action_state_t* new_state();
 
   virtual action_state_t* get_state(const action_state_t* = nullptr);
+
+  unsigned n_allocated_states() const
+  { return allocated_states; }
 private:
   friend struct action_state_t;
   virtual void release_state( action_state_t* );
@@ -0,0 +1,111 @@
+// ==========================================================================
+// Dedmonwakeen's Raid DPS/TPS Simulator.
+// Send questions to natehieter@gmail.com
+// ==========================================================================
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* Lazily built hash index over a vector of named objects ( objects with a name_str member ).
+ *
+ * The index maps names to positions in the vector, and chains the positions of objects sharing a
+ * name in vector order, so lookups return the same object as a linear scan for the first match.
+ * Objects appended to the vector since the last lookup ( e.g. by pet spawners during the
+ * simulation ) are indexed by the next lookup. Any other change to the vector, such as erasing
+ * objects, is detected through the object at the last indexed position and rebuilds the index.
+ *
+ * Renaming an object after it has been indexed is not detected, owners of vectors with renamed
+ * objects have to clear() the index.
+ */
+template <typename T>
+class name_index_t
+{
+  static const size_t npos = static_cast<size_t>( -1 );
+
+  // First and last position of each name
+  std::unordered_map<std::string, std::pair<size_t, size_t>> head;
+  // Next position of the same name, one entry per indexed object
+  std::vector<size_t> next;
+  // Object at the last indexed position
+  const T* last;
+
+  bool valid( const std::vector<T*>& list ) const
+  {
+    return next.size() <= list.size() && ( next.empty() || list[ next.size() - 1 ] == last );
+  }
+
+  void update( const std::vector<T*>& list )
+  {
+    if ( !valid( list ) )
+    {
+      clear();
+    }
+
+    if ( next.size() == list.size() )
+    {
+      return;
+    }
+
+    for ( size_t i = next.size(); i < list.size(); ++i )
+    {
+      next.push_back( npos );
+      auto r = head.emplace( list[ i ]->name_str, std::make_pair( i, i ) );
+      if ( !r.second )
+      {
+        next[ r.first->second.second ] = i;
+        r.first->second.second         = i;
+      }
+    }
+
+    last = list.back();
+  }
+
+public:
+  name_index_t() : last( nullptr )
+  {
+  }
+
+  void clear()
+  {
+    head.clear();
+    next.clear();
+    last = nullptr;
+  }
+
+  // First object in list with the given name, for which pred returns true
+  template <typename Predicate>
+  T* find( const std::vector<T*>& list, const std::string& name, Predicate pred )
+  {
+    update( list );
+
+    auto it = head.find( name );
+    if ( it == head.end() )
+    {
+      return nullptr;
+    }
+
+    for ( size_t i = it->second.first; i != npos; i = next[ i ] )
+    {
+      T* t = list[ i ];
+      if ( t->name_str == name && pred( t ) )
+      {
+        return t;
+      }
+    }
+
+    return nullptr;
+  }
+
+  // First object in list with the given name
+  T* find( const std::vector<T*>& list, const std::string& name )
+  {
+    return find( list, name, []( const T* ) { return true; } );
+  }
+};
+
+template <typename T>
+const size_t name_index_t<T>::npos;
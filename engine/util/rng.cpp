@@ -54,6 +54,43 @@ double convert_to_double_0_1( uint64_t ui64 )
   return u.d - 1.0;
 }
 
+/// MurmurHash3 64-bit finalizer, see rng_murmurhash_t
+uint64_t mix64( uint64_t x )
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  return x ^ ( x >> 33 );
+}
+
+/// Seed identifying stream number stream of the key, never zero
+uint64_t stream_seed( uint64_t key, uint64_t stream )
+{
+  uint64_t s = mix64( key ^ mix64( stream + 0x9e3779b97f4a7c15ULL ) );
+  return s != 0 ? s : 1;
+}
+
+
+/**
+ * Engines generate buffered blocks through a direct call to their own next_real(), so the whole
+ * block is generated without virtual calls. Engines with a single serial state chain gain nothing
+ * from generating ahead, only engines with a block kernel are buffered by default.
+ */
+template <typename Engine>
+struct rng_engine_t : public rng_t
+{
+  rng_engine_t( bool buffered = false ) : rng_t( buffered ) {}
+
+  virtual void fill( double* out, size_t n ) override
+  {
+    Engine& engine = static_cast<Engine&>( *this );
+    for ( size_t i = 0; i < n; ++i )
+    {
+      out[ i ] = engine.Engine::next_real();
+    }
+  }
+};
 
 /**
  * @brief STL Mersenne twister MT19937
@@ -63,7 +100,7 @@ double convert_to_double_0_1( uint64_t ui64 )
  * maintenance cost.
  * Unfortunately, it is slower than the dsfmt implementation.
  */
-struct rng_mt_cxx11_t : public rng_t
+struct rng_mt_cxx11_t : public rng_engine_t<rng_mt_cxx11_t>
 {
   std::mt19937 engine; // Mersenne twister MT19937
   std::uniform_real_distribution<double> dist;
@@ -72,18 +109,18 @@ struct rng_mt_cxx11_t : public rng_t
 
   virtual const char* name() const override { return "mt_cxx11"; }
 
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   { 
     engine.seed( (unsigned) start ); 
   }
 
-  virtual double real() override
+  virtual double next_real() override
   { 
     return dist( engine );
   }
 };
 
-struct rng_mt_cxx11_64_t : public rng_t
+struct rng_mt_cxx11_64_t : public rng_engine_t<rng_mt_cxx11_64_t>
 {
   std::mt19937_64 engine; // Mersenne twister MT19937
 
@@ -91,12 +128,12 @@ struct rng_mt_cxx11_64_t : public rng_t
 
   virtual const char* name() const override { return "mt_cxx11_64"; }
 
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   {
     engine.seed( start );
   }
 
-  virtual double real() override
+  virtual double next_real() override
   {
     return convert_to_double_0_1(engine());
   }
@@ -108,7 +145,7 @@ struct rng_mt_cxx11_64_t : public rng_t
  *
  * All credit goes to https://code.google.com/p/smhasher
  */
-struct rng_murmurhash_t : public rng_t
+struct rng_murmurhash_t : public rng_engine_t<rng_murmurhash_t>
 {
   uint64_t x; /* The state must be seeded with a nonzero value. */
 
@@ -123,13 +160,13 @@ struct rng_murmurhash_t : public rng_t
 
   virtual const char* name() const override { return "murmurhash3"; }
 
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   { 
     assert( start != 0 );
     x = start;
   }
 
-  virtual double real() override
+  virtual double next_real() override
   { 
     return convert_to_double_0_1( next() );
   }
@@ -142,7 +179,7 @@ struct rng_murmurhash_t : public rng_t
  * All credit goes to Sebastiano Vigna (vigna@acm.org) @2014
  * http://xorshift.di.unimi.it/
  */
-struct rng_xorshift64_t : public rng_t
+struct rng_xorshift64_t : public rng_engine_t<rng_xorshift64_t>
 {
   uint64_t x; /* The state must be seeded with a nonzero value. */
 
@@ -156,13 +193,13 @@ struct rng_xorshift64_t : public rng_t
 
   virtual const char* name() const override { return "xorshift64"; }
 
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   { 
     assert( start != 0 );
     x = start;
   }
 
-  virtual double real() override
+  virtual double next_real() override
   { 
     return convert_to_double_0_1( next() );
   }
@@ -175,7 +212,7 @@ struct rng_xorshift64_t : public rng_t
  * All credit goes to Sebastiano Vigna (vigna@acm.org) @2014
  * http://xorshift.di.unimi.it/
  */
-struct rng_xorshift128_t : public rng_t
+struct rng_xorshift128_t : public rng_engine_t<rng_xorshift128_t>
 {
   uint64_t s[ 2 ];
 
@@ -190,7 +227,7 @@ struct rng_xorshift128_t : public rng_t
 
   virtual const char* name() const override { return "xorshift128"; }
 
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   { 
     rng_murmurhash_t mmh;
     mmh.seed( start );
@@ -199,7 +236,7 @@ struct rng_xorshift128_t : public rng_t
     s[ 1 ] = mmh.next();
   }
 
-  virtual double real() override
+  virtual double next_real() override
   { 
     return convert_to_double_0_1( next() );
   }
@@ -212,7 +249,7 @@ struct rng_xorshift128_t : public rng_t
  * All credit goes to Sebastiano Vigna (vigna@acm.org) @2014
  * http://xorshift.di.unimi.it/
  */
-struct rng_xorshift1024_t : public rng_t
+struct rng_xorshift1024_t : public rng_engine_t<rng_xorshift1024_t>
 {
   uint64_t s[ 16 ]; 
   int p;
@@ -229,7 +266,7 @@ struct rng_xorshift1024_t : public rng_t
 
   virtual const char* name() const override { return "xorshift1024"; }
 
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   { 
     rng_xorshift64_t xs64;
     xs64.seed( start );
@@ -237,7 +274,7 @@ struct rng_xorshift1024_t : public rng_t
     p = 0;
   }
 
-  virtual double real() override
+  virtual double next_real() override
   { 
     return convert_to_double_0_1( next() );
   }
@@ -257,7 +294,7 @@ struct rng_xorshift1024_t : public rng_t
  *
  * The new BSD License is applied to this software.
  */
-struct rng_sfmt_t : public rng_t
+struct rng_sfmt_t : public rng_engine_t<rng_sfmt_t>
 {
   /** 128-bit data structure */
   union w128_t
@@ -481,12 +518,15 @@ struct rng_sfmt_t : public rng_t
     return psfmt64[dsfmt->idx++];
   }
 
-#if defined(RNG_USE_SSE2)
-  rng_sfmt_t()
+  rng_sfmt_t() : rng_engine_t( true )
   {
+#if defined(RNG_USE_SSE2)
     // Validate proper alignment for SSE2 types.
     assert( ( uintptr_t ) dsfmt_global_data.status % 16 == 0 );
+#endif
   }
+
+#if defined(RNG_USE_SSE2)
   // 32-bit libraries typically align malloc chunks to sizeof(double) == 8.
   // This object needs to be aligned to sizeof(__m128d) == 16.
   static void* operator new( size_t size )
@@ -503,16 +543,43 @@ struct rng_sfmt_t : public rng_t
 #endif
   }
   
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   { 
     dsfmt_chk_init_gen_rand( &dsfmt_global_data, (uint32_t) start ); 
   }
 
-  virtual double real() override
+  virtual double next_real() override
   { 
     return dsfmt_genrand_close_open( &dsfmt_global_data ) - 1.0; 
   }
 
+  /**
+   * dsfmt generates its whole state array at once, copy blocks straight out of it
+   */
+  virtual void fill( double* out, size_t n ) override
+  {
+    const double* psfmt64 = &dsfmt_global_data.status[0].d[0];
+    while ( n > 0 )
+    {
+      if ( dsfmt_global_data.idx >= DSFMT_N64 )
+      {
+        dsfmt_gen_rand_all( &dsfmt_global_data );
+        dsfmt_global_data.idx = 0;
+      }
+
+      size_t count = std::min( n, static_cast<size_t>( DSFMT_N64 - dsfmt_global_data.idx ) );
+      const double* in = psfmt64 + dsfmt_global_data.idx;
+      for ( size_t i = 0; i < count; ++i )
+      {
+        out[ i ] = in[ i ] - 1.0;
+      }
+
+      dsfmt_global_data.idx += static_cast<int>( count );
+      out += count;
+      n -= count;
+    }
+  }
+
   /**
    * Special implementation because dsfmt only allows 32bit seed
    */
@@ -536,7 +603,7 @@ struct rng_sfmt_t : public rng_t
  * Hiroshima University and The University of Tokyo.
  * All rights reserved.
  */
-struct rng_tinymt_t : public rng_t
+struct rng_tinymt_t : public rng_engine_t<rng_tinymt_t>
 {
   static const uint64_t TINYMT64_SH0  = 12;
   static const uint64_t TINYMT64_SH1  = 11;
@@ -603,7 +670,7 @@ struct rng_tinymt_t : public rng_t
 
   virtual const char* name() const override { return "tinymt"; }
 
-  virtual void seed( uint64_t start ) override
+  virtual void seed_engine( uint64_t start ) override
   {
     // mat1, mat2, and tmat are inputs to the engine
     // I am uncertain how to set them so we'll just grind the seed through MurmurHash.
@@ -616,34 +683,179 @@ struct rng_tinymt_t : public rng_t
     init( start );
   }
 
-  virtual double real() override
+  virtual double next_real() override
   {
     next_state();
     return temper_conv_open() - 1.0;
   }
 };
 
+
+/**
+ * @brief Philox4x32-10 counter-based Random Number Generator
+ *
+ * The output is a bijection of a 128-bit counter under a 64-bit key, so any position of any
+ * stream can be reached directly without running the generator up to it. Streams use the upper
+ * half of the counter, so different stream numbers of the same key never overlap.
+ *
+ * John K. Salmon, Mark A. Moraes, Ron O. Dror, and David E. Shaw, "Parallel Random Numbers: As Easy
+ * as 1, 2, 3", SC11, http://www.thesalmons.org/john/random123/
+ */
+struct rng_philox_t : public rng_engine_t<rng_philox_t>
+{
+  static const uint32_t PHILOX_M0 = 0xD2511F53;
+  static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+  static const uint32_t PHILOX_W0 = 0x9E3779B9;
+  static const uint32_t PHILOX_W1 = 0xBB67AE85;
+  static const int PHILOX_ROUNDS = 10;
+
+  uint32_t key[ 2 ];
+  uint32_t ctr[ 4 ];
+  uint32_t out[ 4 ];
+  int idx; // Next unused 64-bit half of out
+
+  rng_philox_t() : rng_engine_t( true ), key(), ctr(), out(), idx( 2 ) {}
+
+  void next_block()
+  {
+    uint32_t c[ 4 ] = { ctr[ 0 ], ctr[ 1 ], ctr[ 2 ], ctr[ 3 ] };
+    uint32_t k0 = key[ 0 ], k1 = key[ 1 ];
+
+    for ( int round = 0; round < PHILOX_ROUNDS; round++ )
+    {
+      if ( round > 0 )
+      {
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+      }
+
+      uint64_t p0 = uint64_t( PHILOX_M0 ) * c[ 0 ];
+      uint64_t p1 = uint64_t( PHILOX_M1 ) * c[ 2 ];
+      uint32_t n[ 4 ] = { uint32_t( p1 >> 32 ) ^ c[ 1 ] ^ k0, uint32_t( p1 ),
+                          uint32_t( p0 >> 32 ) ^ c[ 3 ] ^ k1, uint32_t( p0 ) };
+      c[ 0 ] = n[ 0 ]; c[ 1 ] = n[ 1 ]; c[ 2 ] = n[ 2 ]; c[ 3 ] = n[ 3 ];
+    }
+
+    out[ 0 ] = c[ 0 ]; out[ 1 ] = c[ 1 ]; out[ 2 ] = c[ 2 ]; out[ 3 ] = c[ 3 ];
+    idx = 0;
+
+    // Advance the position within the stream, the lower half of the counter
+    if ( ++ctr[ 0 ] == 0 )
+    {
+      ++ctr[ 1 ];
+    }
+  }
+
+  /**
+   * Counters are independent of each other, so whole lanes of blocks are generated side by side,
+   * which the compiler maps onto SIMD multiplies
+   */
+  virtual void fill( double* buffer, size_t n ) override
+  {
+    static const size_t LANES = 8;
+
+    // Finish the current block first, block boundaries stay where next_real() would put them
+    for ( ; n > 0 && idx < 2; --n )
+    {
+      *buffer++ = rng_philox_t::next_real();
+    }
+
+    for ( ; n >= 2 * LANES; n -= 2 * LANES, buffer += 2 * LANES )
+    {
+      uint64_t position = uint64_t( ctr[ 0 ] ) | ( uint64_t( ctr[ 1 ] ) << 32 );
+      uint32_t c0[ LANES ], c1[ LANES ], c2[ LANES ], c3[ LANES ];
+      for ( size_t l = 0; l < LANES; ++l )
+      {
+        c0[ l ] = uint32_t( position + l );
+        c1[ l ] = uint32_t( ( position + l ) >> 32 );
+        c2[ l ] = ctr[ 2 ];
+        c3[ l ] = ctr[ 3 ];
+      }
+
+      uint32_t k0 = key[ 0 ], k1 = key[ 1 ];
+      for ( int round = 0; round < PHILOX_ROUNDS; round++ )
+      {
+        if ( round > 0 )
+        {
+          k0 += PHILOX_W0;
+          k1 += PHILOX_W1;
+        }
+
+        for ( size_t l = 0; l < LANES; ++l )
+        {
+          uint64_t p0 = uint64_t( PHILOX_M0 ) * c0[ l ];
+          uint64_t p1 = uint64_t( PHILOX_M1 ) * c2[ l ];
+          c0[ l ] = uint32_t( p1 >> 32 ) ^ c1[ l ] ^ k0;
+          c1[ l ] = uint32_t( p1 );
+          c2[ l ] = uint32_t( p0 >> 32 ) ^ c3[ l ] ^ k1;
+          c3[ l ] = uint32_t( p0 );
+        }
+      }
+
+      for ( size_t l = 0; l < LANES; ++l )
+      {
+        buffer[ 2 * l ] = convert_to_double_0_1( uint64_t( c0[ l ] ) | ( uint64_t( c1[ l ] ) << 32 ) );
+        buffer[ 2 * l + 1 ] = convert_to_double_0_1( uint64_t( c2[ l ] ) | ( uint64_t( c3[ l ] ) << 32 ) );
+      }
+
+      position += LANES;
+      ctr[ 0 ] = uint32_t( position );
+      ctr[ 1 ] = uint32_t( position >> 32 );
+    }
+
+    for ( ; n > 0; --n )
+    {
+      *buffer++ = rng_philox_t::next_real();
+    }
+  }
+
+  void set( uint64_t k, uint64_t stream )
+  {
+    key[ 0 ] = uint32_t( k );
+    key[ 1 ] = uint32_t( k >> 32 );
+    ctr[ 0 ] = ctr[ 1 ] = 0;
+    ctr[ 2 ] = uint32_t( stream );
+    ctr[ 3 ] = uint32_t( stream >> 32 );
+    idx = 2;
+  }
+
+  virtual const char* name() const override { return "philox"; }
+
+  virtual void seed_engine( uint64_t start ) override
+  {
+    set( start, 0 );
+  }
+
+  virtual double next_real() override
+  {
+    if ( idx >= 2 )
+    {
+      next_block();
+    }
+
+    uint64_t r = uint64_t( out[ 2 * idx ] ) | ( uint64_t( out[ 2 * idx + 1 ] ) << 32 );
+    idx++;
+    return convert_to_double_0_1( r );
+  }
+
+  /**
+   * The key and stream map straight onto the key and counter, no seed munging needed
+   */
+  virtual uint64_t seed_stream( uint64_t k, uint64_t stream ) override
+  {
+    set( k, stream );
+    discard_buffer();
+    reset();
+    return stream_seed( k, stream );
+  }
+};
+
 } // unnamed
 
 // ==========================================================================
 // Probability Distributions
 // ==========================================================================
 
-/// Bernoulli Distribution
-bool rng_t::roll( double chance )
-{
-  if ( chance <= 0 ) return false;
-  if ( chance >= 1 ) return true;
-  return real() < chance;
-}
-
-/// Uniform distribution in the range [min max]
-double rng_t::range( double min, double max )
-{
-  assert( min <= max );
-  return min + real() * ( max - min );
-}
-
 /**
  * @brief Gaussian Distribution
  *
@@ -748,6 +960,18 @@ uint64_t rng_t::reseed()
   return w.s;
 }
 
+/**
+ * Seed with a stream derived only from key and stream number, so the same stream is produced no
+ * matter which thread, or how many previous streams, the generator ran before
+ */
+uint64_t rng_t::seed_stream( uint64_t key, uint64_t stream )
+{
+  uint64_t s = stream_seed( key, stream );
+  seed( s );
+  reset();
+  return s;
+}
+
 /// reset any state
 void rng_t::reset()
 {
@@ -755,8 +979,38 @@ void rng_t::reset()
   gauss_pair_use = false;
 }
 
-rng_t::rng_t() :
-    gauss_pair_value( 0.0 ), gauss_pair_use( false )
+/// Default block generation, one engine call per number
+void rng_t::fill( double* out, size_t n )
+{
+  for ( size_t i = 0; i < n; ++i )
+  {
+    out[ i ] = next_real();
+  }
+}
+
+/// Serve a number once the buffer runs out, generating the next block when buffered
+double rng_t::refill()
+{
+  if ( buffer_size == 0 )
+  {
+    return next_real();
+  }
+
+  fill( buffer.data(), buffer_size );
+  buffer_pos = 1;
+  return buffer[ 0 ];
+}
+
+/// Switch between block and single number generation, numbers left in the buffer are dropped
+void rng_t::set_buffered( bool buffered )
+{
+  buffer_size = buffered ? BUFFER_SIZE : 0;
+  buffer_pos = buffer_size;
+}
+
+rng_t::rng_t( bool buffered ) :
+    gauss_pair_value( 0.0 ), gauss_pair_use( false ),
+    buffer_pos( buffered ? BUFFER_SIZE : 0 ), buffer_size( buffered ? BUFFER_SIZE : 0 ), buffer()
 {
 }
 
@@ -774,6 +1028,7 @@ engine_type parse_type( const std::string& n )
   if( n == "xorshift64"   ) return engine_type::XORSHIFT64;
   if( n == "xorshift128"  ) return engine_type::XORSHIFT128;
   if( n == "xorshift1024" ) return engine_type::XORSHIFT1024;
+  if( n == "philox"       ) return engine_type::PHILOX;
 
   return engine_type::DEFAULT;
 }
@@ -806,6 +1061,9 @@ std::unique_ptr<rng_t> create( engine_type t )
   case engine_type::XORSHIFT1024:
     return std::unique_ptr<rng_t>(new rng_xorshift1024_t());
 
+  case engine_type::PHILOX:
+    return std::unique_ptr<rng_t>(new rng_philox_t());
+
   case engine_type::DEFAULT:
   default:
     break;
@@ -1088,6 +1346,34 @@ static void test_uniform_int( rng_t* rng, uint64_t n, unsigned num_buckets )
   fmt::print("time = {} ms\n\n", elapsed_cpu);
 }
 
+// Block buffered generation against one virtual engine call per number
+static void test_buffering( engine_type t, uint64_t n )
+{
+  auto rng = create( t );
+
+  for ( bool buffered : { false, true } )
+  {
+    rng -> set_buffered( buffered );
+    rng -> seed( 31459 );
+
+    int64_t start_time = milliseconds();
+
+    double average = 0;
+    for ( uint64_t i = 0; i < n; ++i )
+    {
+      average += rng -> real();
+    }
+
+    average /= n;
+    int64_t elapsed_cpu = std::max( int64_t( 1 ), milliseconds() - start_time );
+
+    fmt::print( "{} calls to rng::{}::real() {}, average = {:.8f}, time = {} ms, numbers/sec = {}\n",
+                n, rng -> name(), buffered ? "buffered" : "unbuffered", average, elapsed_cpu,
+                static_cast<uint64_t>( n * 1000.0 / elapsed_cpu ) );
+  }
+  fmt::print( "\n" );
+}
+
 } // namespace rng
 
 int main( int /*argc*/, char** /*argv*/ )
@@ -1100,6 +1386,7 @@ int main( int /*argc*/, char** /*argv*/ )
   rng_t* rng_tinymt = new rng_tinymt_t();
   rng_t* rng_xs128  = new rng_xorshift128_t();
   rng_t* rng_xs1024 = new rng_xorshift1024_t();
+  rng_t* rng_philox = new rng_philox_t();
 
   std::random_device rd;
   uint64_t seed  = uint64_t(rd()) | (uint64_t(rd()) << 32);
@@ -1113,6 +1400,7 @@ int main( int /*argc*/, char** /*argv*/ )
   rng_tinymt -> seed( seed );
   rng_xs128  -> seed( seed );
   rng_xs1024 -> seed( seed );
+  rng_philox -> seed( seed );
 
   uint64_t n = 100000000;
 
@@ -1123,6 +1411,7 @@ int main( int /*argc*/, char** /*argv*/ )
   test_one( rng_tinymt, n );
   test_one( rng_xs128,  n );
   test_one( rng_xs1024, n );
+  test_one( rng_philox, n );
 
   monte_carlo( rng_mt_cxx11,   n );
   monte_carlo( rng_murmurhash,   n );
@@ -1130,6 +1419,7 @@ int main( int /*argc*/, char** /*argv*/ )
   monte_carlo( rng_tinymt, n );
   monte_carlo( rng_xs128,  n );
   monte_carlo( rng_xs1024, n );
+  monte_carlo( rng_philox, n );
 
   test_seed( rng_mt_cxx11,   100000 );
   test_seed( rng_murmurhash,   100000 );
@@ -1137,6 +1427,14 @@ int main( int /*argc*/, char** /*argv*/ )
   test_seed( rng_tinymt, 100000 );
   test_seed( rng_xs128,  100000 );
   test_seed( rng_xs1024, 100000 );
+  test_seed( rng_philox, 100000 );
+
+  for ( engine_type t : { engine_type::MURMURHASH, engine_type::SFMT, engine_type::STD,
+                          engine_type::TINYMT, engine_type::XORSHIFT64, engine_type::XORSHIFT128,
+                          engine_type::XORSHIFT1024, engine_type::PHILOX } )
+  {
+    test_buffering( t, n );
+  }
 
   unsigned num_buckets = 10;
   uint64_t k = 10000;
@@ -1146,6 +1444,7 @@ int main( int /*argc*/, char** /*argv*/ )
   test_uniform_int( rng_tinymt,     k, num_buckets );
   test_uniform_int( rng_xs128,      k, num_buckets );
   test_uniform_int( rng_xs1024,     k, num_buckets );
+  test_uniform_int( rng_philox,     k, num_buckets );
 
   std::cout << "random device: min=" << rd.min() << " max=" << rd.max() << "\n\n";
 
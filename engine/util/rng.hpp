@@ -9,6 +9,8 @@
 /*! \defgroup SC_RNG Random Number Generator */
 
 #include "config.hpp"
+#include <array>
+#include <cassert>
 #include <memory>
 #include "sc_timespan.hpp"
 
@@ -20,7 +22,7 @@ namespace rng {
 
 /// rng engines
 enum class engine_type {
-  DEFAULT, MURMURHASH, SFMT, STD, TINYMT, XORSHIFT64, XORSHIFT128, XORSHIFT1024
+  DEFAULT, MURMURHASH, SFMT, STD, TINYMT, XORSHIFT64, XORSHIFT128, XORSHIFT1024, PHILOX
 };
 
 /**\ingroup SC_RNG
@@ -28,22 +30,53 @@ enum class engine_type {
  *
  * Implements different rng-engines, selectable through a factory,
  * as well as different distribution outputs ( uniform, gauss, etc. )
+ *
+ * Engines with a block kernel generate uniform numbers in blocks into a buffer, which is served
+ * without a virtual call. Buffering does not change the sequence of numbers an engine produces.
  */
 struct rng_t
 {
+  static const size_t BUFFER_SIZE = 256;
 
   virtual ~rng_t() {}
   /// name of rng engine
   virtual const char* name() const = 0;
   /// seed rng engine
-  virtual void seed( uint64_t start ) = 0;
+  void seed( uint64_t start )
+  {
+    seed_engine( start );
+    discard_buffer();
+  }
   /// uniform distribution in range [0,1]
-  virtual double real() = 0;
+  double real()
+  {
+    if ( buffer_pos < buffer_size )
+    {
+      return buffer[ buffer_pos++ ];
+    }
+    return refill();
+  }
   virtual uint64_t reseed();
+  /// seed rng engine with stream number stream of the key, independent of the current state
+  virtual uint64_t seed_stream( uint64_t key, uint64_t stream );
   virtual void reset();
+  /// generate numbers in blocks of BUFFER_SIZE, or one at a time
+  void set_buffered( bool buffered );
 
-  bool roll( double chance );
-  double range( double min, double max );
+  /// Bernoulli distribution
+  bool roll( double chance )
+  {
+    if ( chance <= 0 ) return false;
+    if ( chance >= 1 ) return true;
+    return real() < chance;
+  }
+
+  /// Uniform distribution in the range [min max]
+  double range( double min, double max )
+  {
+    assert( min <= max );
+    return min + real() * ( max - min );
+  }
 
   template<class T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
   T range(T min, T max)
@@ -65,12 +98,25 @@ struct rng_t
   timespan_t gauss( timespan_t mean, timespan_t stddev );
   timespan_t exgauss( timespan_t mean, timespan_t stddev, timespan_t nu );
 protected:
-  rng_t();
+  rng_t( bool buffered = true );
+  /// seed the engine itself
+  virtual void seed_engine( uint64_t start ) = 0;
+  /// next uniform number in range [0,1] of the engine
+  virtual double next_real() = 0;
+  /// fill out with the next n uniform numbers of the engine
+  virtual void fill( double* out, size_t n );
+  /// drop buffered numbers generated before the engine state was changed
+  void discard_buffer()
+  { buffer_pos = buffer_size; }
 private:
+  double refill();
+
   // Allow re-use of unused ( but necessary ) random number of a previous call to gauss()  
   double gauss_pair_value; 
   bool   gauss_pair_use;
 
+  size_t buffer_pos, buffer_size;
+  std::array<double, BUFFER_SIZE> buffer;
 };
 
 std::unique_ptr<rng_t> create( engine_type = engine_type::DEFAULT );
@@ -6,9 +6,11 @@
 #ifndef SAMPLE_DATA_HPP
 #define SAMPLE_DATA_HPP
 
+#include <atomic>
 #include <limits>
 #include <numeric>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 #include "util/generic.hpp"
 
@@ -334,9 +336,337 @@ public:
   }
 };
 
+/* Running mean and variance ( Welford ), without storing the samples.
+ * Running data of separate sequences merge into the data of the combined sequence ( Chan et al. )
+ */
+class running_sample_data_t
+{
+public:
+  using value_t = double;
+
+private:
+  size_t _count  = 0;
+  value_t _mean  = 0.0;
+  value_t _m2    = 0.0;  // Sum of squared deviations from the mean
+
+public:
+  running_sample_data_t() = default;
+
+  running_sample_data_t( size_t count, value_t mean, value_t m2 ) : _count( count ), _mean( mean ), _m2( m2 )
+  {
+  }
+
+  void add( value_t x )
+  {
+    ++_count;
+    value_t delta = x - _mean;
+    _mean += delta / _count;
+    _m2 += delta * ( x - _mean );
+  }
+
+  void merge( const running_sample_data_t& other )
+  {
+    if ( other._count == 0 )
+      return;
+
+    size_t count  = _count + other._count;
+    value_t delta = other._mean - _mean;
+    _mean += delta * other._count / count;
+    _m2 += other._m2 + delta * delta * _count * other._count / count;
+    _count = count;
+  }
+
+  size_t count() const
+  {
+    return _count;
+  }
+
+  value_t mean() const
+  {
+    return _mean;
+  }
+
+  value_t m2() const
+  {
+    return _m2;
+  }
+
+  // Population variance, same as statistics::calculate_variance
+  value_t variance() const
+  {
+    return _count > 1 ? _m2 / _count : value_t();
+  }
+
+  // Standard Deviation of the Mean ( Central Limit Theorem )
+  value_t mean_std_dev() const
+  {
+    return _count > 1 ? std::sqrt( variance() / _count ) : value_t();
+  }
+};
+
+/* Quantile sketch ( merging t-digest, Dunning & Ertl ) of a sequence of samples, without storing
+ * the samples. Samples are buffered and merged into weighted centroids, which are kept small near
+ * the tails and large around the median.
+ *
+ * Memory is bounded by roughly 2 * compression centroids plus a buffer of 5 * compression samples.
+ * The rank error of a quantile is about 1 / compression around the median and drops towards
+ * q( 1 - q ) / compression near the tails; the minimum and maximum are exact. Sketches of separate
+ * sequences merge into the sketch of the combined sequence.
+ */
+class quantile_sketch_t
+{
+public:
+  using value_t = double;
+
+private:
+  struct centroid_t
+  {
+    value_t mean;
+    value_t weight;
+
+    bool operator<( const centroid_t& other ) const
+    {
+      return mean < other.mean;
+    }
+  };
+
+  value_t compression;
+  std::vector<centroid_t> centroids;  // Merged, ordered by mean
+  std::vector<centroid_t> buffer;     // Not yet merged
+  value_t merged_weight, buffered_weight;
+  value_t _min, _max;
+
+  // Scale function k1, centroid sizes are limited to one unit of k
+  value_t scale( value_t q ) const
+  {
+    return compression / ( 2 * m_pi ) * std::asin( 2 * q - 1 );
+  }
+
+  value_t inverse_scale( value_t k ) const
+  {
+    if ( k >= compression / 4 )
+      return 1.0;
+
+    return ( std::sin( k * 2 * m_pi / compression ) + 1 ) / 2;
+  }
+
+  size_t buffer_limit() const
+  {
+    return static_cast<size_t>( 5 * compression );
+  }
+
+public:
+  quantile_sketch_t( value_t compression_ = 100.0 )
+    : compression( std::max( compression_, 10.0 ) ),
+      merged_weight( 0 ),
+      buffered_weight( 0 ),
+      _min( std::numeric_limits<value_t>::max() ),
+      _max( std::numeric_limits<value_t>::lowest() )
+  {
+  }
+
+  void add( value_t x, value_t weight = 1.0 )
+  {
+    buffer.push_back( centroid_t{ x, weight } );
+    buffered_weight += weight;
+    _min = std::min( _min, x );
+    _max = std::max( _max, x );
+
+    if ( buffer.size() >= buffer_limit() )
+      flush();
+  }
+
+  void merge( const quantile_sketch_t& other )
+  {
+    if ( other.empty() )
+      return;
+
+    buffer.insert( buffer.end(), other.centroids.begin(), other.centroids.end() );
+    buffer.insert( buffer.end(), other.buffer.begin(), other.buffer.end() );
+    buffered_weight += other.merged_weight + other.buffered_weight;
+    _min = std::min( _min, other._min );
+    _max = std::max( _max, other._max );
+
+    flush();
+  }
+
+  // Merge buffered samples into the centroids. Required before querying the sketch.
+  void flush()
+  {
+    if ( buffer.empty() )
+      return;
+
+    buffer.insert( buffer.end(), centroids.begin(), centroids.end() );
+    range::sort( buffer );
+    centroids.clear();
+
+    value_t total      = merged_weight + buffered_weight;
+    value_t so_far     = 0;  // Weight of the completed centroids
+    value_t limit      = total * inverse_scale( scale( 0 ) + 1 );
+    centroid_t current = buffer.front();
+
+    for ( size_t i = 1; i < buffer.size(); ++i )
+    {
+      const centroid_t& next = buffer[ i ];
+      if ( so_far + current.weight + next.weight <= limit )
+      {
+        current.weight += next.weight;
+        current.mean += ( next.mean - current.mean ) * next.weight / current.weight;
+      }
+      else
+      {
+        so_far += current.weight;
+        limit = total * inverse_scale( scale( so_far / total ) + 1 );
+        centroids.push_back( current );
+        current = next;
+      }
+    }
+    centroids.push_back( current );
+
+    buffer.clear();
+    merged_weight   = total;
+    buffered_weight = 0;
+  }
+
+  bool empty() const
+  {
+    return merged_weight + buffered_weight == 0;
+  }
+
+  bool flushed() const
+  {
+    return buffer.empty();
+  }
+
+  // Number of centroids kept
+  size_t size() const
+  {
+    return centroids.size();
+  }
+
+  // Heap memory held by the sketch, in bytes
+  size_t memory_size() const
+  {
+    return ( centroids.capacity() + buffer.capacity() ) * sizeof( centroid_t );
+  }
+
+  /* Value at quantile q, interpolating linearly between the centers of neighbouring centroids.
+   * Requires: flushed
+   */
+  value_t quantile( double q ) const
+  {
+    assert( q >= 0 && q <= 1.0 );
+    assert( flushed() );
+
+    if ( centroids.empty() )
+      return 0;
+
+    if ( q <= 0 )
+      return _min;
+    if ( q >= 1 )
+      return _max;
+
+    value_t index = q * merged_weight;
+
+    // Below the center of the first centroid, between the minimum and its mean
+    value_t center = centroids.front().weight / 2;
+    if ( index < center )
+      return _min + ( centroids.front().mean - _min ) * index / center;
+
+    for ( size_t i = 1; i < centroids.size(); ++i )
+    {
+      value_t next_center = center + ( centroids[ i - 1 ].weight + centroids[ i ].weight ) / 2;
+      if ( index < next_center )
+      {
+        value_t t = ( index - center ) / ( next_center - center );
+        return centroids[ i - 1 ].mean + ( centroids[ i ].mean - centroids[ i - 1 ].mean ) * t;
+      }
+      center = next_center;
+    }
+
+    // Above the center of the last centroid, between its mean and the maximum
+    value_t t = ( index - center ) / ( merged_weight - center );
+    return centroids.back().mean + ( _max - centroids.back().mean ) * t;
+  }
+
+  /* Fraction of the samples below x, the inverse of quantile()
+   * Requires: flushed
+   */
+  value_t cdf( value_t x ) const
+  {
+    assert( flushed() );
+
+    if ( centroids.empty() || x < _min )
+      return 0;
+    if ( x >= _max )
+      return 1;
+
+    value_t center = centroids.front().weight / 2;
+    if ( x < centroids.front().mean )
+    {
+      value_t range = centroids.front().mean - _min;
+      return ( range > 0 ? center * ( x - _min ) / range : 0 ) / merged_weight;
+    }
+
+    for ( size_t i = 1; i < centroids.size(); ++i )
+    {
+      value_t next_center = center + ( centroids[ i - 1 ].weight + centroids[ i ].weight ) / 2;
+      if ( x < centroids[ i ].mean )
+      {
+        value_t range = centroids[ i ].mean - centroids[ i - 1 ].mean;
+        value_t t     = range > 0 ? ( x - centroids[ i - 1 ].mean ) / range : 0;
+        return ( center + ( next_center - center ) * t ) / merged_weight;
+      }
+      center = next_center;
+    }
+
+    value_t range = _max - centroids.back().mean;
+    value_t t     = range > 0 ? ( x - centroids.back().mean ) / range : 0;
+    return ( center + ( merged_weight - center ) * t ) / merged_weight;
+  }
+
+  /* Estimated histogram ( not normalized ) over [min, max]. Bucket counts add up to the sample count.
+   * Requires: flushed
+   */
+  std::vector<size_t> histogram( size_t num_buckets, value_t min, value_t max ) const
+  {
+    std::vector<size_t> result;
+    if ( centroids.empty() || num_buckets == 0 || !( max > min ) )
+      return result;
+
+    result.assign( num_buckets, size_t{} );
+    size_t previous = 0;
+    for ( size_t i = 0; i < num_buckets; ++i )
+    {
+      size_t cumulative = static_cast<size_t>( merged_weight );
+      if ( i + 1 < num_buckets )
+      {
+        value_t edge = min + ( max - min ) * ( i + 1 ) / num_buckets;
+        cumulative   = static_cast<size_t>( std::round( merged_weight * cdf( edge ) ) );
+      }
+      cumulative  = std::max( cumulative, previous );
+      result[ i ] = cumulative - previous;
+      previous    = cumulative;
+    }
+
+    return result;
+  }
+
+  void clear()
+  {
+    centroids.clear();
+    buffer.clear();
+    merged_weight = buffered_weight = 0;
+    _min = std::numeric_limits<value_t>::max();
+    _max = std::numeric_limits<value_t>::lowest();
+  }
+};
+
 /* Extensive sample_data container with two runtime dependent modes:
  * - simple: Only offers sum, count
  *  -!simple: saves data and offers variance, percentiles, distribution, etc.
+ * A !simple container can be switched to a sketch ( see enable_sketch ), which offers the same
+ * analysis in bounded memory, with estimated percentiles and distribution, but keeps no data.
  */
 class extended_sample_data_t : public simple_sample_data_with_min_max_t
 {
@@ -355,6 +685,9 @@ private:
                                       // original, unsorted order ( for example
                                       // to do regression on it )
   bool is_sorted;
+  bool is_sketched;
+  running_sample_data_t running;
+  quantile_sketch_t sketch;
 
 public:
   extended_sample_data_t( const std::string& n, bool s = true )
@@ -366,17 +699,45 @@ public:
       mean_variance(),
       mean_std_dev(),
       simple( s ),
-      is_sorted( false )
+      is_sorted( false ),
+      is_sketched( false )
   {
   }
 
   void change_mode( bool simple )
   {
     this->simple = simple;
+    is_sketched  = false;
 
     clear();
   }
 
+  /* Collect a !simple container into a quantile sketch with the given compression instead of
+   * storing the samples. Must be enabled before any data is collected.
+   */
+  void enable_sketch( double compression )
+  {
+    if ( simple || compression <= 0 )
+      return;
+
+    is_sketched = true;
+    sketch      = quantile_sketch_t( compression );
+
+    clear();
+  }
+
+  bool sketched() const
+  {
+    return is_sketched;
+  }
+
+  // Heap memory held by the container, in bytes
+  size_t memory_size() const
+  {
+    return ( _data.capacity() + _sorted_data.capacity() ) * sizeof( value_t ) +
+           distribution.capacity() * sizeof( size_t ) + sketch.memory_size();
+  }
+
   const char* name() const
   {
     return name_str.c_str();
@@ -385,7 +746,7 @@ public:
   // Reserve memory
   void reserve( std::size_t capacity )
   {
-    if ( !simple )
+    if ( !simple && !is_sketched )
       _data.reserve( capacity );
   }
 
@@ -396,6 +757,13 @@ public:
     {
       base_t::add( x );
     }
+    else if ( is_sketched )
+    {
+      base_t::add( x );
+      running.add( x );
+      sketch.add( x );
+      is_sorted = false;
+    }
     else
     {
       _data.push_back( x );
@@ -410,7 +778,7 @@ public:
 
   size_t size() const
   {
-    if ( simple )
+    if ( simple || is_sketched )
       return base_t::count();
 
     return _data.size();
@@ -435,6 +803,12 @@ public:
     if ( simple )
       return;
 
+    if ( is_sketched )
+    {  // Sum and min/max are collected as the samples are added
+      _mean = running.mean();
+      return;
+    }
+
     if ( data().empty() )
       return;
 
@@ -464,7 +838,7 @@ public:
   }
   size_t count() const
   {
-    return simple ? base_t::count() : data().size();
+    return simple || is_sketched ? base_t::count() : data().size();
   }
 
   /* Analyze Variance: Variance, Stddev and Stddev of the mean
@@ -475,16 +849,16 @@ public:
     if ( simple )
       return;
 
-    if ( _data.empty() )
+    if ( count() == 0 )
       return;
 
-    variance = statistics::calculate_variance( data(), mean() );
+    variance = is_sketched ? running.variance() : statistics::calculate_variance( data(), mean() );
     std_dev  = std::sqrt( variance );
 
     // Calculate Standard Deviation of the Mean ( Central Limit Theorem )
-    if ( data().size() > 1 )
+    if ( count() > 1 )
     {
-      mean_variance = variance / data().size();
+      mean_variance = variance / count();
       mean_std_dev  = std::sqrt( mean_variance );
     }
   }
@@ -501,6 +875,12 @@ public:
     {
       return;
     }
+    if ( is_sketched )
+    {
+      sketch.flush();
+      is_sorted = true;
+      return;
+    }
     _sorted_data = _data;
     range::sort( _sorted_data );
     is_sorted = true;
@@ -515,17 +895,37 @@ public:
     if ( simple )
       return;
 
-    if ( data().empty() )
+    if ( count() == 0 )
       return;
 
-    distribution = statistics::create_histogram( data(), num_buckets,
-                                                 base_t::min(), base_t::max() );
+    distribution = histogram( num_buckets, base_t::min(), base_t::max() );
+  }
+
+  /* Histogram ( not normalized ) of the data over [min, max], estimated from the sketch if the
+   * container is sketched.
+   *
+   * Requires: sorted if sketched
+   */
+  std::vector<size_t> histogram( size_t num_buckets, value_t min, value_t max ) const
+  {
+    if ( is_sketched )
+      return sketch.histogram( num_buckets, min, max );
+
+    return statistics::create_histogram( data(), num_buckets, min, max );
   }
 
   void clear()
   {
     base_t::_count = 0;
     base_t::_sum   = 0.0;
+    if ( is_sketched )
+    {
+      base_t::_found = false;
+      base_t::_min   = std::numeric_limits<value_t>::max();
+      base_t::_max   = std::numeric_limits<value_t>::lowest();
+      running        = running_sample_data_t();
+      sketch.clear();
+    }
     _sorted_data.clear();
     _data.clear();
     distribution.clear();
@@ -541,12 +941,15 @@ public:
     if ( simple )
       return 0;
 
-    if ( data().empty() )
+    if ( count() == 0 )
       return 0;
 
     if ( !is_sorted )
       return base_t::nan();
 
+    if ( is_sketched )
+      return sketch.quantile( x );
+
     // Should be improved to use linear interpolation
     return ( sorted_data()[ (int)( x * ( sorted_data().size() - 1 ) ) ] );
   }
@@ -563,11 +966,19 @@ public:
   void merge( const extended_sample_data_t& other )
   {
     assert( simple == other.simple );
+    assert( is_sketched == other.is_sketched );
 
     if ( simple )
     {
       base_t::merge( other );
     }
+    else if ( is_sketched )
+    {
+      base_t::merge( other );
+      running.merge( other.running );
+      sketch.merge( other.sketch );
+      is_sorted = false;
+    }
     else
       _data.insert( _data.end(), other._data.begin(), other._data.end() );
   }
@@ -593,4 +1004,91 @@ public:
 
 };  // sample_data_t
 
+/* Running sample data with a single writer thread, which any other thread can read at any time.
+ * The writer publishes each update through a sequence counter, readers retry the rare snapshot that
+ * overlaps an update, so neither side ever takes a lock.
+ */
+class concurrent_running_sample_data_t
+{
+  std::atomic<unsigned> sequence;
+  std::atomic<size_t> _count;
+  std::atomic<double> _mean, _m2;
+
+public:
+  concurrent_running_sample_data_t() : sequence( 0 ), _count( 0 ), _mean( 0 ), _m2( 0 )
+  {
+  }
+
+  // Writer thread only
+  void add( double x )
+  {
+    running_sample_data_t data( _count.load( std::memory_order_relaxed ),
+                                _mean.load( std::memory_order_relaxed ),
+                                _m2.load( std::memory_order_relaxed ) );
+    data.add( x );
+
+    unsigned seq = sequence.load( std::memory_order_relaxed );
+    sequence.store( seq + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    _count.store( data.count(), std::memory_order_relaxed );
+    _mean.store( data.mean(), std::memory_order_relaxed );
+    _m2.store( data.m2(), std::memory_order_relaxed );
+
+    sequence.store( seq + 2, std::memory_order_release );
+  }
+
+  running_sample_data_t snapshot() const
+  {
+    while ( true )
+    {
+      unsigned seq = sequence.load( std::memory_order_acquire );
+
+      size_t count = _count.load( std::memory_order_relaxed );
+      double mean  = _mean.load( std::memory_order_relaxed );
+      double m2    = _m2.load( std::memory_order_relaxed );
+
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( ( seq & 1 ) == 0 && seq == sequence.load( std::memory_order_relaxed ) )
+      {
+        return running_sample_data_t( count, mean, m2 );
+      }
+    }
+  }
+};
+
+/* Statistics of the differences b - a between two series of per-iteration samples, paired by the
+ * key of each iteration (for example its random stream). Samples without a partner are skipped.
+ */
+inline running_sample_data_t paired_difference( const std::vector<uint64_t>& keys_a,
+                                                const std::vector<double>& a,
+                                                const std::vector<uint64_t>& keys_b,
+                                                const std::vector<double>& b )
+{
+  running_sample_data_t diff;
+
+  if ( keys_a.size() != a.size() || keys_b.size() != b.size() )
+  {
+    return diff;
+  }
+
+  std::unordered_map<uint64_t, double> values;
+  values.reserve( a.size() );
+  for ( size_t i = 0; i < a.size(); ++i )
+  {
+    values[ keys_a[ i ] ] = a[ i ];
+  }
+
+  for ( size_t i = 0; i < b.size(); ++i )
+  {
+    auto it = values.find( keys_b[ i ] );
+    if ( it != values.end() )
+    {
+      diff.add( b[ i ] - it->second );
+    }
+  }
+
+  return diff;
+}
+
 #endif  // SAMPLE_DATA_HPP
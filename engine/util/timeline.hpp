@@ -16,8 +16,67 @@
 #include "sample_data.hpp"
 #include "sc_timespan.hpp"
 
+#if defined(__SSE2__) || ( defined( SC_VS ) && ( defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) ) )
+#  define TIMELINE_USE_SSE2
+#  include <emmintrin.h>
+#endif
+
 struct sim_t;
 
+/* Element-wise kernels over timeline bins, two bins per SSE2 instruction where available.
+ * Source and destination may not overlap.
+ */
+namespace timeline_kernel
+{
+// dst[ i ] += src[ i ]
+inline void add( double* dst, const double* src, size_t n )
+{
+  size_t i = 0;
+#if defined(TIMELINE_USE_SSE2)
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    _mm_storeu_pd( dst + i, _mm_add_pd( _mm_loadu_pd( dst + i ), _mm_loadu_pd( src + i ) ) );
+    _mm_storeu_pd( dst + i + 2, _mm_add_pd( _mm_loadu_pd( dst + i + 2 ), _mm_loadu_pd( src + i + 2 ) ) );
+  }
+#endif
+  for ( ; i < n; ++i )
+    dst[ i ] += src[ i ];
+}
+
+// dst[ i ] /= divisor[ i ]
+inline void divide( double* dst, const double* divisor, size_t n )
+{
+  size_t i = 0;
+#if defined(TIMELINE_USE_SSE2)
+  for ( ; i + 2 <= n; i += 2 )
+    _mm_storeu_pd( dst + i, _mm_div_pd( _mm_loadu_pd( dst + i ), _mm_loadu_pd( divisor + i ) ) );
+#endif
+  for ( ; i < n; ++i )
+    dst[ i ] /= divisor[ i ];
+}
+
+// Sum of src, accumulated in four interleaved partial sums
+inline double sum( const double* src, size_t n )
+{
+  size_t i = 0;
+  double result = 0;
+#if defined(TIMELINE_USE_SSE2)
+  __m128d a = _mm_setzero_pd(), b = _mm_setzero_pd();
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    a = _mm_add_pd( a, _mm_loadu_pd( src + i ) );
+    b = _mm_add_pd( b, _mm_loadu_pd( src + i + 2 ) );
+  }
+  double partial[ 2 ];
+  _mm_storeu_pd( partial, _mm_add_pd( a, b ) );
+  result = partial[ 0 ] + partial[ 1 ];
+#endif
+  for ( ; i < n; ++i )
+    result += src[ i ];
+  return result;
+}
+}  // namespace timeline_kernel
+
 template <typename Fwd, typename Out>
 void sliding_window_average( Fwd first, Fwd last, unsigned window, Out out )
 {
@@ -88,6 +147,10 @@ public:
   const std::vector<double>& data() const
   { return _data; }
 
+  // Heap memory held by the timeline, in bytes
+  size_t memory_size() const
+  { return _data.capacity() * sizeof( double ); }
+
   void init( size_t length )
   { _data.assign( length, 0.0 ); }
 
@@ -121,12 +184,17 @@ public:
     }
   }
 
+  void adjust( const std::vector<double>& divisor_timeline )
+  {
+    timeline_kernel::divide( _data.data(), divisor_timeline.data(), std::min( _data.size(), divisor_timeline.size() ) );
+  }
+
   double mean() const
   { 
     if ( data().size() == 0 )
       return 0;
 
-    return statistics::calculate_mean( data() );
+    return timeline_kernel::sum( _data.data(), _data.size() ) / _data.size();
   }
 
   double mean_stddev() const
@@ -141,8 +209,7 @@ public:
   void merge( const timeline_t& other )
   {
     // merge shared range
-    for ( size_t j = 0, num_buckets = std::min( _data.size(), other.data().size() ); j < num_buckets; ++j )
-      _data[ j ] += other.data()[ j ];
+    timeline_kernel::add( _data.data(), other._data.data(), std::min( _data.size(), other._data.size() ) );
 
     // if other is larger, insert tail
     if ( _data.size() < other.data().size() )
@@ -250,11 +317,11 @@ public:
    */
   void create_histogram( const extended_sample_data_t& sd, size_t num_buckets, double min, double max )
   {
-    if ( sd.simple || sd.data().empty() )
+    if ( sd.simple || sd.count() == 0 )
       return;
     clear();
     _min = min; _max = max;
-    _data = statistics::create_histogram( sd.data(), num_buckets, _min, _max );
+    _data = sd.histogram( num_buckets, _min, _max );
     calculate_num_entries();
   }
 
@@ -262,10 +329,10 @@ public:
    */
   void create_histogram( const extended_sample_data_t& sd, size_t num_buckets )
   {
-    if ( sd.simple || sd.data().empty() )
+    if ( sd.simple || sd.count() == 0 )
       return;
-    double min = *std::min_element( sd.data().begin(), sd.data().end() );
-    double max = *std::max_element( sd.data().begin(), sd.data().end() );
+    double min = sd.sketched() ? sd.min() : *std::min_element( sd.data().begin(), sd.data().end() );
+    double max = sd.sketched() ? sd.max() : *std::max_element( sd.data().begin(), sd.data().end() );
     create_histogram( sd, num_buckets, min, max );
   }
 
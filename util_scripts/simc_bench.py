@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+# Runs a fixed matrix of canned SimulationCraft workloads and records their
+# throughput, phase timings and peak memory use as JSON. With --compare, the
+# results are checked against a stored baseline and regressions are reported
+# through the exit status.
+#
+# Usage:
+#   simc_bench.py --simc ../engine/simc --profiles ../profiles --output bench.json
+#   simc_bench.py --simc ../engine/simc --profiles ../profiles --compare baseline.json
+#
+# Only the Python standard library is used.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+try:
+    import resource
+except ImportError:
+    resource = None
+
+FORMAT_VERSION = 1
+
+# Workload used for the AoE, profileset and scale factor runs
+REFERENCE_PROFILE = "T22_Warrior_Fury.simc"
+
+NUM_PROFILESETS = 200
+
+# Metric name -> True if larger values are better
+METRICS = {
+    "iterations_per_second": True,
+    "events_per_second": True,
+    "wall_seconds": False,
+    "init_time_seconds": False,
+    "merge_time_seconds": False,
+    "analyze_time_seconds": False,
+    "peak_rss_kb": False,
+}
+
+# Phase timings are tiny for most workloads; ignore changes below this noise
+# floor (in seconds) when comparing.
+MIN_TIME_DELTA = 0.05
+
+
+def workload_matrix(profiles_dir):
+    tier_dir = os.path.join(profiles_dir, "Tier22")
+    reference = os.path.join(tier_dir, REFERENCE_PROFILE)
+
+    workloads = []
+    for name in sorted(os.listdir(tier_dir)):
+        if not name.startswith("T22_") or not name.endswith(".simc"):
+            continue
+        workloads.append({
+            "name": "single_target_" + name[4:-5].lower(),
+            "inputs": [os.path.join(tier_dir, name)],
+            "options": [],
+        })
+
+    workloads.append({
+        "name": "aoe_5_targets",
+        "inputs": [reference],
+        "options": ["desired_targets=5"],
+    })
+    workloads.append({
+        "name": "raid",
+        "inputs": [os.path.join(profiles_dir, "T22_Raid.simc")],
+        "options": [],
+    })
+    workloads.append({
+        "name": "profileset_%d" % NUM_PROFILESETS,
+        "inputs": [reference],
+        "profilesets": NUM_PROFILESETS,
+        "options": [],
+    })
+    workloads.append({
+        "name": "scale_factors",
+        "inputs": [reference],
+        "options": ["calculate_scale_factors=1"],
+    })
+    return workloads
+
+
+def write_profilesets(directory, count):
+    path = os.path.join(directory, "profilesets.simc")
+    with open(path, "w") as f:
+        for i in range(count):
+            f.write("profileset.bench_%03d+=enchant_stamina=%d\n" % (i, i + 1))
+    return path
+
+
+def run_child(command, log_path):
+    """Run command, returning (exit status, peak RSS in KiB or None, log tail)."""
+    with open(log_path, "w") as log:
+        process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=log)
+        rss = None
+        if hasattr(os, "wait4"):
+            _, status, usage = os.wait4(process.pid, 0)
+            # Popen still owns the pid, record the status so it does not wait again
+            process.returncode = (status >> 8) if os.WIFEXITED(status) else -1
+            rss = usage.ru_maxrss
+            if sys.platform == "darwin":
+                rss //= 1024
+        else:
+            process.wait()
+            if resource is not None:
+                # Best effort: maximum over all children waited for so far
+                rss = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+
+    with open(log_path, errors="replace") as log:
+        tail = log.read()[-500:]
+    return process.returncode, rss, tail
+
+
+def run_workload(args, workload, scratch):
+    report_path = os.path.join(scratch, workload["name"] + ".json")
+    command = [args.simc] + workload["inputs"]
+    if workload.get("profilesets"):
+        command.append(write_profilesets(scratch, workload["profilesets"]))
+    command += workload["options"]
+    command += [
+        "iterations=%d" % args.iterations,
+        "threads=%d" % args.threads,
+        "seed=%d" % args.seed,
+        "target_error=0",
+        "json2=" + report_path,
+    ]
+
+    start = time.time()
+    status, rss, stderr = run_child(command, report_path + ".log")
+    wall = time.time() - start
+
+    if status != 0 or not os.path.exists(report_path):
+        return {"error": "simc exited with status %d: %s" % (status, stderr.strip())}
+
+    with open(report_path) as f:
+        report = json.load(f)
+    stats = report["sim"]["statistics"]
+    elapsed = stats["elapsed_time_seconds"]
+    iterations = report["sim"]["options"]["iterations"]
+    # The elapsed time also covers every profileset sim, count their iterations too
+    for result in report["sim"].get("profilesets", {}).get("results", []):
+        iterations += result.get("iterations", 0)
+
+    return {
+        "iterations": iterations,
+        "total_events_processed": stats["total_events_processed"],
+        "iterations_per_second": iterations / elapsed if elapsed > 0 else 0.0,
+        "events_per_second": stats["total_events_processed"] / elapsed if elapsed > 0 else 0.0,
+        "wall_seconds": wall,
+        "init_time_seconds": stats["init_time_seconds"],
+        "merge_time_seconds": stats["merge_time_seconds"],
+        "analyze_time_seconds": stats["analyze_time_seconds"],
+        "peak_rss_kb": rss,
+    }
+
+
+def compare(results, baseline, tolerance):
+    """Return a list of human readable regression descriptions."""
+    regressions = []
+    for name, base in sorted(baseline["workloads"].items()):
+        current = results["workloads"].get(name)
+        if current is None or "error" in current:
+            regressions.append("%s: missing or failed in current run" % name)
+            continue
+        if "error" in base:
+            continue
+        for metric, higher_is_better in METRICS.items():
+            old, new = base.get(metric), current.get(metric)
+            if old is None or new is None or old <= 0:
+                continue
+            if metric.endswith("_seconds") and abs(new - old) < MIN_TIME_DELTA:
+                continue
+            change = (new - old) / old
+            if higher_is_better:
+                change = -change
+            if change > tolerance:
+                regressions.append("%s: %s %.6g -> %.6g (%+.1f%%)" % (
+                    name, metric, old, new, 100.0 * (new - old) / old))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="SimulationCraft benchmark matrix")
+    parser.add_argument("--simc", required=True, help="path to the simc executable")
+    parser.add_argument("--profiles", required=True, help="path to the profiles directory")
+    parser.add_argument("--output", default="simc_bench.json", help="result file")
+    parser.add_argument("--compare", metavar="BASELINE", help="baseline result file to compare against")
+    parser.add_argument("--tolerance", type=float, default=0.05,
+                        help="relative change treated as a regression (default 0.05)")
+    parser.add_argument("--iterations", type=int, default=1000)
+    parser.add_argument("--threads", type=int, default=1)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--filter", default="", help="only run workloads whose name contains this string")
+    args = parser.parse_args()
+
+    results = {
+        "version": FORMAT_VERSION,
+        "iterations": args.iterations,
+        "threads": args.threads,
+        "seed": args.seed,
+        "workloads": {},
+    }
+
+    failed = False
+    scratch = tempfile.mkdtemp(prefix="simc_bench_")
+    for workload in workload_matrix(args.profiles):
+        if args.filter not in workload["name"]:
+            continue
+        print("Running %s ..." % workload["name"], flush=True)
+        result = run_workload(args, workload, scratch)
+        results["workloads"][workload["name"]] = result
+        if "error" in result:
+            failed = True
+            print("  %s" % result["error"])
+        else:
+            print("  %.1f iterations/s, %.0f events/s, %.2fs wall, peak RSS %s KiB" % (
+                result["iterations_per_second"], result["events_per_second"],
+                result["wall_seconds"], result["peak_rss_kb"]))
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+    print("Results written to %s" % args.output)
+
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+        if (baseline.get("iterations"), baseline.get("threads")) != (args.iterations, args.threads):
+            print("Warning: baseline was recorded with iterations=%s threads=%s" % (
+                baseline.get("iterations"), baseline.get("threads")))
+        if args.filter:
+            baseline["workloads"] = {k: v for k, v in baseline["workloads"].items() if args.filter in k}
+        regressions = compare(results, baseline, args.tolerance)
+        if regressions:
+            print("Regressions against %s:" % args.compare)
+            for line in regressions:
+                print("  " + line)
+            return 1
+        print("No regressions against %s" % args.compare)
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())